@@ -33,6 +33,58 @@ GST_DEBUG_CATEGORY_STATIC (debug_category);
 # define SET_CUSTOM_DATA(env, thiz, fieldID, data) (*env)->SetLongField (env, thiz, fieldID, (jlong)(jint)data)
 #endif
 
+/* Messages are passed to Java through native memory wrapped once in direct
+ * ByteBuffers (nativeGetOutputBuffers()). onBytesReady() names the slot that
+ * was filled, Java reads it in place and gives it back with
+ * nativeReleaseBuffer(); when every slot is still out the writer waits. */
+#define OUTPUT_RING_SLOTS 4
+#define OUTPUT_SLOT_SIZE (64 * 1024)
+
+typedef struct _OutputRing
+{
+  guint8 *mem;                  /* OUTPUT_RING_SLOTS * OUTPUT_SLOT_SIZE bytes */
+  gboolean busy[OUTPUT_RING_SLOTS];     /* Filled and not released by Java yet */
+  guint next;                   /* Slot to fill next */
+  gint registered;              /* Java holds the ByteBuffers, accessed atomically */
+  gboolean closed;              /* Shutting down, stop waiting for Java */
+  GMutex lock;
+  GCond cond;
+} OutputRing;
+
+/* Device classes as a bitmask, the same values as DeviceMonitor.Device */
+#define DEVICE_CLASS_SOURCE  (1 << 0)
+#define DEVICE_CLASS_SINK    (1 << 1)
+#define DEVICE_CLASS_AUDIO   (1 << 2)
+#define DEVICE_CLASS_VIDEO   (1 << 3)
+#define DEVICE_CLASS_CAMERA  (1 << 4)   /* "CameraSource" */
+
+/* One device the monitor reported. Everything Java gets is formatted once,
+ * when the device is found or changes, not on every query. */
+typedef struct _DeviceRecord
+{
+  gint id;                      /* Unique while the table lives */
+  GstDevice *device;            /* NULL while only known from the cache */
+  gchar *name;
+  gchar *device_class;          /* As reported, e.g. "Video/Source" */
+  guint classes;                /* DEVICE_CLASS_* */
+  gint *caps;                   /* Caps handles, one per caps structure */
+  guint n_caps;
+  gchar **properties;           /* Key, value, key, value, ... NULL */
+  gchar *launch_line;           /* Made on first request, NULL until then */
+} DeviceRecord;
+
+/* Devices found so far, read by Java through nativeGetDevices(). Caps are
+ * interned: records refer to them by handle, and Java fetches the string
+ * for a handle once with nativeGetCaps(). */
+typedef struct _DeviceTable
+{
+  GPtrArray *records;           /* DeviceRecord, in the order found */
+  gint next_id;
+  GHashTable *caps_handles;     /* Caps string -> handle + 1 */
+  GPtrArray *caps;              /* Handle -> caps string */
+  GMutex lock;
+} DeviceTable;
+
 /* Structure to contain all our information, so we can pass it to callbacks */
 typedef struct _CustomData
 {
@@ -41,6 +93,8 @@ typedef struct _CustomData
   GMainContext *context;        /* GLib context used to run the main loop */
   GMainLoop *main_loop;         /* GLib main loop */
   gboolean initialized;         /* To avoid informing the UI multiple times about the initialization */
+  OutputRing ring;              /* Buffers shared with Java for messages */
+  DeviceTable devices;          /* What the monitor found */
 } CustomData;
 
 /* These global variables cache values which are not changing during execution */
@@ -49,7 +103,13 @@ static pthread_key_t current_jni_env;
 static JavaVM *java_vm;
 static jfieldID custom_data_field_id;
 static jmethodID set_message_method_id;
+static jmethodID on_bytes_ready_method_id;
+static jmethodID on_benchmark_string_method_id;
+static jmethodID on_benchmark_bytes_method_id;
 static jmethodID on_gstreamer_initialized_method_id;
+static jmethodID on_devices_changed_method_id;
+static jclass device_class;
+static jmethodID device_constructor_id;
 
 /*
  * Private methods
@@ -97,12 +157,57 @@ get_jni_env (void)
   return env;
 }
 
+/* Pass @message to Java through the shared buffers: @method is called
+ * with (slot, offset, length), onBytesReady() for the UI */
+static gboolean
+set_ui_message_bytes (JNIEnv * env, const gchar * message, CustomData * data,
+    jmethodID method)
+{
+  OutputRing *ring = &data->ring;
+  gsize len = strlen (message);
+  guint slot;
+
+  if (!g_atomic_int_get (&ring->registered))
+    return FALSE;
+
+  if (len > OUTPUT_SLOT_SIZE) {
+    /* truncate on a character boundary */
+    len = g_utf8_find_prev_char (message, message + OUTPUT_SLOT_SIZE + 1)
+        - message;
+  }
+
+  g_mutex_lock (&ring->lock);
+  while (ring->busy[ring->next] && !ring->closed)
+    g_cond_wait (&ring->cond, &ring->lock);
+  if (ring->closed) {
+    g_mutex_unlock (&ring->lock);
+    return TRUE;
+  }
+  slot = ring->next;
+  ring->busy[slot] = TRUE;
+  ring->next = (slot + 1) % OUTPUT_RING_SLOTS;
+  g_mutex_unlock (&ring->lock);
+
+  memcpy (ring->mem + slot * OUTPUT_SLOT_SIZE, message, len);
+
+  (*env)->CallVoidMethod (env, data->app, method, (jint) slot, (jint) 0,
+      (jint) len);
+  if ((*env)->ExceptionCheck (env)) {
+    GST_ERROR ("Failed to call Java method");
+    (*env)->ExceptionClear (env);
+  }
+  return TRUE;
+}
+
 /* Change the content of the UI's TextView */
 static void
 set_ui_message (const gchar * message, CustomData * data)
 {
   JNIEnv *env = get_jni_env ();
   GST_DEBUG ("Setting message to: %s", message);
+  if (set_ui_message_bytes (env, message, data, on_bytes_ready_method_id))
+    return;
+  /* Java has not picked up the shared buffers yet */
   jstring jmessage = (*env)->NewStringUTF (env, message);
   (*env)->CallVoidMethod (env, data->app, set_message_method_id, jmessage);
   if ((*env)->ExceptionCheck (env)) {
@@ -111,6 +216,19 @@ set_ui_message (const gchar * message, CustomData * data)
   }
   (*env)->DeleteLocalRef (env, jmessage);
 }
+
+/* Tell the UI the device table changed, it queries it with nativeGetDevices() */
+static void
+notify_devices_changed (CustomData * data)
+{
+  JNIEnv *env = get_jni_env ();
+
+  (*env)->CallVoidMethod (env, data->app, on_devices_changed_method_id);
+  if ((*env)->ExceptionCheck (env)) {
+    GST_ERROR ("Failed to call Java method");
+    (*env)->ExceptionClear (env);
+  }
+}
 #if 0
 /* Retrieve errors from the bus and show them on the UI */
 static void
@@ -170,21 +288,114 @@ typedef struct
     GMainLoop *loop;
     GstDeviceMonitor *monitor;
     guint bus_watch_id;
+    CustomData *data;
+    guint coalesce_ms;            /* 0 handles each message on its own */
+    GHashTable *pending;          /* latest GstDevice -> PendingEvent */
+    GPtrArray *pending_order;     /* PendingEvent, in the order first seen */
+    guint n_pending_messages;
+    guint flush_id;
+    gint64 burst_start;
 } DevMonApp;
 
 static gboolean bus_msg_handler (GstBus * bus, GstMessage * msg, gpointer data);
 
-static gchar *
-get_launch_line (GstDevice * device)
+/* Serialized default values of the properties get_launch_line() looks at,
+ * per factory name. A factory's defaults are read from a throwaway element
+ * the first time one of its devices is seen; after that only the device
+ * element gets created. Entries stay for the life of the process; a factory
+ * whose element couldn't be created gets no entry and is tried again. */
+static GMutex factory_defaults_lock;
+static GHashTable *factory_defaults;
+
+static gboolean
+launch_line_property_wanted (GParamSpec * property)
 {
     static const char *const ignored_propnames[] =
             { "name", "parent", "direction", "template", "caps", NULL };
+    gint j;
+
+    /* skip some properties */
+    if ((property->flags & G_PARAM_READWRITE) != G_PARAM_READWRITE)
+        return FALSE;
+
+    for (j = 0; ignored_propnames[j]; j++)
+        if (!g_strcmp0 (ignored_propnames[j], property->name))
+            return FALSE;
+
+    return TRUE;
+}
+
+/* Property name -> serialized default, NULL where it can't be serialized.
+ * Returns NULL if no element could be created to read them from. */
+static GHashTable *
+factory_defaults_build (GstElementFactory * factory)
+{
+    GHashTable *defaults;
+    GstElement *pureelement;
+    GParamSpec **properties, *property;
+    GValue value = G_VALUE_INIT;
+    guint i, number_of_properties;
+
+    pureelement = gst_element_factory_create (factory, NULL);
+    if (!pureelement)
+        return NULL;
+
+    defaults = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_free);
+
+    /* Can't use _param_value_defaults () because sub-classes modify the
+     * values already.
+     */
+    properties =
+            g_object_class_list_properties (G_OBJECT_GET_CLASS (pureelement),
+                                            &number_of_properties);
+    for (i = 0; properties && i < number_of_properties; i++) {
+        property = properties[i];
+
+        if (!launch_line_property_wanted (property))
+            continue;
+
+        g_value_init (&value, property->value_type);
+        g_object_get_property (G_OBJECT (pureelement), property->name, &value);
+        g_hash_table_insert (defaults, g_strdup (property->name),
+                             gst_value_serialize (&value));
+        g_value_unset (&value);
+    }
+    g_free (properties);
+    gst_object_unref (pureelement);
+
+    return defaults;
+}
+
+static GHashTable *
+factory_defaults_get (GstElementFactory * factory)
+{
+    const gchar *name = gst_plugin_feature_get_name (factory);
+    GHashTable *defaults;
+
+    g_mutex_lock (&factory_defaults_lock);
+    if (factory_defaults == NULL)
+        factory_defaults = g_hash_table_new_full (g_str_hash, g_str_equal,
+                                                  g_free, (GDestroyNotify) g_hash_table_unref);
+
+    defaults = g_hash_table_lookup (factory_defaults, name);
+    if (defaults == NULL) {
+        defaults = factory_defaults_build (factory);
+        if (defaults != NULL)
+            g_hash_table_insert (factory_defaults, g_strdup (name), defaults);
+    }
+    g_mutex_unlock (&factory_defaults_lock);
+
+    return defaults;
+}
+
+static gchar *
+get_launch_line (GstDevice * device)
+{
     GString *launch_line;
     GstElement *element;
-    GstElement *pureelement;
+    GHashTable *defaults;
     GParamSpec **properties, *property;
     GValue value = G_VALUE_INIT;
-    GValue pvalue = G_VALUE_INIT;
     guint i, number_of_properties;
     GstElementFactory *factory;
 
@@ -206,7 +417,8 @@ get_launch_line (GstDevice * device)
 
     launch_line = g_string_new (gst_plugin_feature_get_name (factory));
 
-    pureelement = gst_element_factory_create (factory, NULL);
+    /* Without them every property counts as changed */
+    defaults = factory_defaults_get (factory);
 
     /* get paramspecs and show non-default properties */
     properties =
@@ -214,197 +426,912 @@ get_launch_line (GstDevice * device)
                                             &number_of_properties);
     if (properties) {
         for (i = 0; i < number_of_properties; i++) {
-            gint j;
-            gboolean ignore = FALSE;
-            property = properties[i];
+            gchar *valuestr;
+            const gchar *defaultstr;
 
-            /* skip some properties */
-            if ((property->flags & G_PARAM_READWRITE) != G_PARAM_READWRITE)
-                continue;
-
-            for (j = 0; ignored_propnames[j]; j++)
-                if (!g_strcmp0 (ignored_propnames[j], property->name))
-                    ignore = TRUE;
+            property = properties[i];
 
-            if (ignore)
+            if (!launch_line_property_wanted (property))
                 continue;
 
-            /* Can't use _param_value_defaults () because sub-classes modify the
-             * values already.
-             */
-
             g_value_init (&value, property->value_type);
-            g_value_init (&pvalue, property->value_type);
             g_object_get_property (G_OBJECT (element), property->name, &value);
-            g_object_get_property (G_OBJECT (pureelement), property->name, &pvalue);
-            if (gst_value_compare (&value, &pvalue) != GST_VALUE_EQUAL) {
-                gchar *valuestr = gst_value_serialize (&value);
-
-                if (!valuestr) {
-                    GST_WARNING ("Could not serialize property %s:%s",
-                                 GST_OBJECT_NAME (element), property->name);
-                    g_free (valuestr);
-                    goto next;
-                }
-
-                g_string_append_printf (launch_line, " %s=%s",
-                                        property->name, valuestr);
+            valuestr = gst_value_serialize (&value);
+            g_value_unset (&value);
+
+            defaultstr = defaults ?
+                    g_hash_table_lookup (defaults, property->name) : NULL;
+            if (defaultstr != NULL && !g_strcmp0 (valuestr, defaultstr)) {
                 g_free (valuestr);
+                continue;
+            }
 
+            if (!valuestr) {
+                GST_WARNING ("Could not serialize property %s:%s",
+                             GST_OBJECT_NAME (element), property->name);
+                continue;
             }
 
-            next:
-            g_value_unset (&value);
-            g_value_unset (&pvalue);
+            g_string_append_printf (launch_line, " %s=%s",
+                                    property->name, valuestr);
+            g_free (valuestr);
         }
         g_free (properties);
     }
 
     gst_object_unref (element);
-    gst_object_unref (pureelement);
 
     return g_string_free (launch_line, FALSE);
 }
 
 
-static gboolean
-print_structure_field (GQuark field_id, const GValue * value,
-                       gpointer user_data)
+static void
+device_record_free (DeviceRecord * record)
 {
-    gchar *val;
+    if (record->device)
+        gst_object_unref (record->device);
+    g_free (record->name);
+    g_free (record->device_class);
+    g_free (record->caps);
+    g_strfreev (record->properties);
+    g_free (record->launch_line);
+    g_free (record);
+}
 
-    if (G_VALUE_HOLDS_UINT (value)) {
-        val = g_strdup_printf ("%u (0x%08x)", g_value_get_uint (value),
-                               g_value_get_uint (value));
-    } else {
-        val = gst_value_serialize (value);
+static void
+device_table_init (DeviceTable * table)
+{
+    table->records =
+            g_ptr_array_new_with_free_func ((GDestroyNotify) device_record_free);
+    table->caps_handles = g_hash_table_new (g_str_hash, g_str_equal);
+    table->caps = g_ptr_array_new_with_free_func (g_free);
+    g_mutex_init (&table->lock);
+}
+
+static void
+device_table_clear (DeviceTable * table)
+{
+    g_ptr_array_unref (table->records);
+    g_hash_table_unref (table->caps_handles);
+    g_ptr_array_unref (table->caps);
+    g_mutex_clear (&table->lock);
+}
+
+static guint
+device_classes_from_string (const gchar * class_string)
+{
+    static const struct
+    {
+        const gchar *name;
+        guint bits;
+    } known[] = {
+            {"Source", DEVICE_CLASS_SOURCE},
+            {"Sink", DEVICE_CLASS_SINK},
+            {"Audio", DEVICE_CLASS_AUDIO},
+            {"Video", DEVICE_CLASS_VIDEO},
+            {"CameraSource", DEVICE_CLASS_CAMERA},
+    };
+    gchar **parts, **part;
+    guint i, classes = 0;
+
+    if (class_string == NULL)
+        return 0;
+
+    parts = g_strsplit (class_string, "/", -1);
+    for (part = parts; *part != NULL; part++)
+        for (i = 0; i < G_N_ELEMENTS (known); i++)
+            if (!strcmp (*part, known[i].name))
+                classes |= known[i].bits;
+    g_strfreev (parts);
+
+    return classes;
+}
+
+/* Takes @str. Call with the table lock held. */
+static gint
+device_table_intern_caps (DeviceTable * table, gchar * str)
+{
+    gpointer handle = g_hash_table_lookup (table->caps_handles, str);
+
+    if (handle != NULL) {
+        g_free (str);
+        return GPOINTER_TO_INT (handle) - 1;
     }
 
-    if (val != NULL)
-        GST_INFO ("\n\t\t%s = %s", g_quark_to_string (field_id), val);
-    else
-        GST_INFO ("\n\t\t%s - could not serialise field of type %s",
-                 g_quark_to_string (field_id), G_VALUE_TYPE_NAME (value));
+    g_ptr_array_add (table->caps, str);
+    g_hash_table_insert (table->caps_handles, str,
+                         GINT_TO_POINTER (table->caps->len));
+    return table->caps->len - 1;
+}
+
+/* Call with the table lock held */
+static DeviceRecord *
+device_table_lookup (DeviceTable * table, gint id)
+{
+    guint i;
 
-    g_free (val);
+    for (i = 0; i < table->records->len; i++) {
+        DeviceRecord *record = g_ptr_array_index (table->records, i);
 
-    return TRUE;
+        if (record->id == id)
+            return record;
+    }
+    return NULL;
 }
 
 static gboolean
-print_field (GQuark field, const GValue * value, gpointer unused)
+collect_property (GQuark field_id, const GValue * value, gpointer user_data)
 {
-    gchar *str = gst_value_serialize (value);
+    GPtrArray *properties = user_data;
+    gchar *val;
 
-    GST_INFO (", %s=%s", g_quark_to_string (field), str);
-    g_free (str);
+    if (G_VALUE_HOLDS_UINT (value))
+        val = g_strdup_printf ("%u", g_value_get_uint (value));
+    else
+        val = gst_value_serialize (value);
+
+    if (val == NULL) {
+        GST_DEBUG ("%s - could not serialise field of type %s",
+                   g_quark_to_string (field_id), G_VALUE_TYPE_NAME (value));
+        return TRUE;
+    }
+
+    g_ptr_array_add (properties, g_strdup (g_quark_to_string (field_id)));
+    g_ptr_array_add (properties, val);
     return TRUE;
 }
 
-static void
-print_device (GstDevice * device, gboolean modified)
+/* A record for @device, with its caps as strings in @caps_strings until
+ * they are interned by device_table_insert() */
+static DeviceRecord *
+device_record_new (GstDevice * device, GPtrArray * caps_strings)
 {
-    gchar *device_class, *str, *name;
-    GstCaps *caps;
+    DeviceRecord *record = g_new0 (DeviceRecord, 1);
+    GPtrArray *properties = g_ptr_array_new ();
     GstStructure *props;
-    guint i, size = 0;
+    GstCaps *caps;
+    guint i;
+
+    record->device = gst_object_ref (device);
+    record->name = gst_device_get_display_name (device);
+    record->device_class = gst_device_get_device_class (device);
+    record->classes = device_classes_from_string (record->device_class);
 
     caps = gst_device_get_caps (device);
+    for (i = 0; caps != NULL && i < gst_caps_get_size (caps); i++) {
+        GstCaps *structure_caps = gst_caps_copy_nth (caps, i);
+
+        g_ptr_array_add (caps_strings, gst_caps_to_string (structure_caps));
+        gst_caps_unref (structure_caps);
+    }
     if (caps != NULL)
-        size = gst_caps_get_size (caps);
+        gst_caps_unref (caps);
 
-    name = gst_device_get_display_name (device);
-    device_class = gst_device_get_device_class (device);
     props = gst_device_get_properties (device);
+    if (props) {
+        gst_structure_foreach (props, collect_property, properties);
+        gst_structure_free (props);
+    }
+    g_ptr_array_add (properties, NULL);
+    record->properties = (gchar **) g_ptr_array_free (properties, FALSE);
+
+    return record;
+}
+
+static gboolean
+device_record_equal (const DeviceRecord * a, const DeviceRecord * b)
+{
+    guint i;
+
+    if (g_strcmp0 (a->name, b->name) || g_strcmp0 (a->device_class, b->device_class)
+        || a->n_caps != b->n_caps)
+        return FALSE;
+
+    for (i = 0; i < a->n_caps; i++)
+        if (a->caps[i] != b->caps[i])
+            return FALSE;
+
+    for (i = 0; a->properties[i] != NULL && b->properties[i] != NULL; i++)
+        if (strcmp (a->properties[i], b->properties[i]))
+            return FALSE;
+
+    return a->properties[i] == NULL && b->properties[i] == NULL;
+}
+
+/* The record for @record's device, or for @replaces, the device it
+ * superseded (DEVICE_CHANGED swaps the GstDevice). Call with the table lock
+ * held. */
+static gint
+device_table_find (DeviceTable * table, DeviceRecord * record,
+                   GstDevice * replaces)
+{
+    guint i;
+
+    for (i = 0; i < table->records->len; i++) {
+        DeviceRecord *old = g_ptr_array_index (table->records, i);
+
+        if (old->device == record->device
+            || (replaces != NULL && old->device == replaces))
+            return i;
+    }
+
+    /* a device from the cache that this live one takes over */
+    for (i = 0; i < table->records->len; i++) {
+        DeviceRecord *old = g_ptr_array_index (table->records, i);
+
+        if (old->device == NULL && !g_strcmp0 (old->name, record->name)
+            && !g_strcmp0 (old->device_class, record->device_class))
+            return i;
+    }
 
-    GST_INFO ("\nDevice %s:\n\n", modified ? "modified" : "found");
-    GST_INFO ("\tname  : %s\n", name);
-    GST_INFO ("\tclass : %s\n", device_class);
-    for (i = 0; i < size; ++i) {
-        GstStructure *s = gst_caps_get_structure (caps, i);
-        GstCapsFeatures *features = gst_caps_get_features (caps, i);
-
-        GST_INFO ("\t%s %s", (i == 0) ? "caps  :" : "       ",
-                 gst_structure_get_name (s));
-        if (features && (gst_caps_features_is_any (features) ||
-                         !gst_caps_features_is_equal (features,
-                                                      GST_CAPS_FEATURES_MEMORY_SYSTEM_MEMORY))) {
-            gchar *features_string = gst_caps_features_to_string (features);
-
-            GST_INFO ("(%s)", features_string);
-            g_free (features_string);
+    return -1;
+}
+
+/* Put @record in the table, replacing the one for the same device or for
+ * @replaces if there is one. The caps strings are taken. Returns whether
+ * the table looks any different to Java afterwards. */
+static gboolean
+device_table_insert (DeviceTable * table, DeviceRecord * record,
+                     GPtrArray * caps_strings, GstDevice * replaces)
+{
+    DeviceRecord *old;
+    gboolean changed = TRUE;
+    guint i;
+    gint index;
+
+    g_mutex_lock (&table->lock);
+
+    record->n_caps = caps_strings->len;
+    record->caps = g_new (gint, caps_strings->len);
+    for (i = 0; i < caps_strings->len; i++)
+        record->caps[i] = device_table_intern_caps (table,
+                                                    g_ptr_array_index (caps_strings, i));
+
+    index = device_table_find (table, record, replaces);
+    if (index >= 0) {
+        old = g_ptr_array_index (table->records, index);
+        record->id = old->id;
+        changed = !device_record_equal (old, record);
+        /* what the last run worked out still holds */
+        if (!changed && old->device == NULL) {
+            record->launch_line = old->launch_line;
+            old->launch_line = NULL;
         }
-        gst_structure_foreach (s, print_field, NULL);
-        GST_INFO ("\n");
+        table->records->pdata[index] = record;
+        device_record_free (old);
+    } else {
+        record->id = table->next_id++;
+        g_ptr_array_add (table->records, record);
     }
-    if (props) {
-        GST_INFO ("\tproperties:");
-        gst_structure_foreach (props, print_structure_field, NULL);
-        gst_structure_free (props);
-        GST_INFO ("\n");
+
+    g_mutex_unlock (&table->lock);
+
+    return changed;
+}
+
+/* Returns the id @device had, or -1 */
+static gint
+device_table_remove (DeviceTable * table, GstDevice * device)
+{
+    guint i;
+    gint id = -1;
+
+    g_mutex_lock (&table->lock);
+    for (i = 0; i < table->records->len; i++) {
+        DeviceRecord *record = g_ptr_array_index (table->records, i);
+
+        if (record->device == device) {
+            id = record->id;
+            g_ptr_array_remove_index (table->records, i);
+            break;
+        }
     }
-    str = get_launch_line (device);
-    if (gst_device_has_classes (device, "Source"))
-        GST_INFO ("\tgst-launch-1.0 %s ! ...\n", str);
-    else if (gst_device_has_classes (device, "Sink"))
-        GST_INFO ("\tgst-launch-1.0 ... ! %s\n", str);
-    else if (gst_device_has_classes (device, "CameraSource")) {
-        GST_INFO ("\tgst-launch-1.0 %s.vfsrc name=camerasrc ! ... "
-                 "camerasrc.vidsrc ! [video/x-h264] ... \n", str);
+    g_mutex_unlock (&table->lock);
+
+    return id;
+}
+
+/* Let go of @device but keep its record, like a cached one, so that the
+ * same device coming back as a new GstDevice takes it over again.
+ * device_table_remove_cached() drops it if nothing does. */
+static void
+device_table_detach (DeviceTable * table, GstDevice * device)
+{
+    guint i;
+
+    g_mutex_lock (&table->lock);
+    for (i = 0; i < table->records->len; i++) {
+        DeviceRecord *record = g_ptr_array_index (table->records, i);
+
+        if (record->device == device) {
+            gst_object_unref (record->device);
+            record->device = NULL;
+            break;
+        }
     }
+    g_mutex_unlock (&table->lock);
+}
 
-    g_free (str);
-    GST_INFO ("\n");
+/* Drop the cached devices no live device took over. Returns how many. */
+static guint
+device_table_remove_cached (DeviceTable * table)
+{
+    guint i, removed = 0;
 
-    g_free (name);
-    g_free (device_class);
+    g_mutex_lock (&table->lock);
+    for (i = table->records->len; i > 0; i--) {
+        DeviceRecord *record = g_ptr_array_index (table->records, i - 1);
 
-    if (caps != NULL)
-        gst_caps_unref (caps);
+        if (record->device == NULL) {
+            GST_INFO ("Device gone: %s, id %d", record->name, record->id);
+            g_ptr_array_remove_index (table->records, i - 1);
+            removed++;
+        }
+    }
+    g_mutex_unlock (&table->lock);
+
+    return removed;
+}
+
+/* Last known devices, so the UI has a list before the providers are up.
+ *
+ * Layout: DeviceCacheHeader, n_devices DeviceCacheEntry, n_refs guint32
+ * string offsets the entries index into (caps, then property keys and
+ * values), and a blob of NUL terminated strings, each stored once. All
+ * offsets are from the start of the file, which is mapped as is. */
+#define DEVICE_CACHE_MAGIC   0x44545347 /* "GSTD" */
+#define DEVICE_CACHE_VERSION 1
+
+typedef struct
+{
+    guint32 magic;
+    guint32 version;
+    guint32 n_devices;
+    guint32 n_refs;
+} DeviceCacheHeader;
+
+typedef struct
+{
+    guint32 name_offset;
+    guint32 class_offset;
+    guint32 launch_line_offset; /* 0 if not known */
+    guint32 classes;
+    guint32 first_caps;
+    guint32 n_caps;
+    guint32 first_property;
+    guint32 n_properties;       /* refs, two per property */
+} DeviceCacheEntry;
+
+static gchar *
+device_cache_path (void)
+{
+    return g_build_filename (g_get_user_cache_dir (),
+                             "gst-device-monitor-cache.bin", NULL);
+}
+
+static const gchar *
+device_cache_string (GMappedFile * file, guint32 offset)
+{
+    gsize length = g_mapped_file_get_length (file);
+    const gchar *base = g_mapped_file_get_contents (file);
+
+    if (offset >= length || memchr (base + offset, '\0', length - offset) == NULL)
+        return NULL;
+    return base + offset;
+}
+
+static gboolean
+device_cache_entry_valid (GMappedFile * file, const DeviceCacheHeader * header,
+                          const guint32 * refs, const DeviceCacheEntry * entry)
+{
+    guint i;
+
+    if (!device_cache_string (file, entry->name_offset)
+        || !device_cache_string (file, entry->class_offset)
+        || (entry->launch_line_offset
+            && !device_cache_string (file, entry->launch_line_offset))
+        || entry->first_caps > header->n_refs
+        || entry->n_caps > header->n_refs - entry->first_caps
+        || entry->first_property > header->n_refs
+        || entry->n_properties > header->n_refs - entry->first_property
+        || entry->n_properties % 2)
+        return FALSE;
+
+    for (i = 0; i < entry->n_caps; i++)
+        if (!device_cache_string (file, refs[entry->first_caps + i]))
+            return FALSE;
+    for (i = 0; i < entry->n_properties; i++)
+        if (!device_cache_string (file, refs[entry->first_property + i]))
+            return FALSE;
+
+    return TRUE;
+}
+
+/* Fill the table with the devices of the last run. They have no GstDevice
+ * until a live device with the same name and class takes them over. Returns
+ * how many were loaded. */
+static guint
+device_cache_load (DeviceTable * table)
+{
+    GMappedFile *file;
+    const DeviceCacheHeader *header;
+    const DeviceCacheEntry *entries;
+    const guint32 *refs;
+    gchar *path;
+    gsize length;
+    guint i, j, loaded = 0;
+
+    path = device_cache_path ();
+    file = g_mapped_file_new (path, FALSE, NULL);
+    g_free (path);
+    if (file == NULL)
+        return 0;
+
+    length = g_mapped_file_get_length (file);
+    header = (const DeviceCacheHeader *) g_mapped_file_get_contents (file);
+    if (length < sizeof (DeviceCacheHeader)
+        || header->magic != DEVICE_CACHE_MAGIC
+        || header->version != DEVICE_CACHE_VERSION
+        || (length - sizeof (DeviceCacheHeader)) / sizeof (DeviceCacheEntry) <
+           header->n_devices
+        || (length - sizeof (DeviceCacheHeader) -
+            header->n_devices * sizeof (DeviceCacheEntry)) / sizeof (guint32) <
+           header->n_refs) {
+        GST_WARNING ("Ignoring invalid device cache");
+        g_mapped_file_unref (file);
+        return 0;
+    }
+
+    entries = (const DeviceCacheEntry *) (header + 1);
+    refs = (const guint32 *) (entries + header->n_devices);
+
+    g_mutex_lock (&table->lock);
+    for (i = 0; i < header->n_devices; i++) {
+        const DeviceCacheEntry *entry = &entries[i];
+        DeviceRecord *record;
+
+        if (!device_cache_entry_valid (file, header, refs, entry)) {
+            GST_WARNING ("Skipping invalid device cache entry %u", i);
+            continue;
+        }
+
+        record = g_new0 (DeviceRecord, 1);
+        record->id = table->next_id++;
+        record->name = g_strdup (device_cache_string (file, entry->name_offset));
+        record->device_class =
+                g_strdup (device_cache_string (file, entry->class_offset));
+        record->classes = entry->classes;
+        if (entry->launch_line_offset)
+            record->launch_line =
+                    g_strdup (device_cache_string (file, entry->launch_line_offset));
+
+        record->n_caps = entry->n_caps;
+        record->caps = g_new (gint, entry->n_caps);
+        for (j = 0; j < entry->n_caps; j++)
+            record->caps[j] = device_table_intern_caps (table,
+                                                        g_strdup (device_cache_string (file, refs[entry->first_caps + j])));
+
+        record->properties = g_new0 (gchar *, entry->n_properties + 1);
+        for (j = 0; j < entry->n_properties; j++)
+            record->properties[j] =
+                    g_strdup (device_cache_string (file, refs[entry->first_property + j]));
+
+        g_ptr_array_add (table->records, record);
+        loaded++;
+    }
+    g_mutex_unlock (&table->lock);
+
+    g_mapped_file_unref (file);
+    GST_DEBUG ("Loaded %u cached devices", loaded);
+
+    return loaded;
+}
+
+/* Offset of @str in @blob, adding it the first time */
+static guint32
+device_cache_blob_add (GByteArray * blob, GHashTable * offsets,
+                       const gchar * str)
+{
+    gpointer offset;
+
+    if (g_hash_table_lookup_extended (offsets, str, NULL, &offset))
+        return GPOINTER_TO_UINT (offset);
+
+    offset = GUINT_TO_POINTER (blob->len);
+    g_byte_array_append (blob, (const guint8 *) str, strlen (str) + 1);
+    g_hash_table_insert (offsets, (gpointer) str, offset);
+    return GPOINTER_TO_UINT (offset);
+}
+
+static void
+device_cache_save (DeviceTable * table)
+{
+    DeviceCacheHeader header = { DEVICE_CACHE_MAGIC, DEVICE_CACHE_VERSION, };
+    DeviceCacheEntry *entries;
+    GArray *refs;
+    GByteArray *blob;
+    GHashTable *offsets;
+    GError *error = NULL;
+    gchar *path, *contents, *dir;
+    guint32 base;
+    gsize size;
+    guint i, j;
+
+    refs = g_array_new (FALSE, FALSE, sizeof (guint32));
+    blob = g_byte_array_new ();
+    offsets = g_hash_table_new (g_str_hash, g_str_equal);
+    /* nothing real sits at offset 0, it means "not known" */
+    g_byte_array_append (blob, (const guint8 *) "", 1);
+
+    g_mutex_lock (&table->lock);
+    header.n_devices = table->records->len;
+    entries = g_new0 (DeviceCacheEntry, header.n_devices);
+    for (i = 0; i < table->records->len; i++) {
+        DeviceRecord *record = g_ptr_array_index (table->records, i);
+        DeviceCacheEntry *entry = &entries[i];
+
+        entry->name_offset = device_cache_blob_add (blob, offsets, record->name);
+        entry->class_offset = device_cache_blob_add (blob, offsets,
+                                                     record->device_class ? record->device_class : "");
+        if (record->launch_line)
+            entry->launch_line_offset = device_cache_blob_add (blob, offsets,
+                                                               record->launch_line);
+        entry->classes = record->classes;
+
+        entry->first_caps = refs->len;
+        entry->n_caps = record->n_caps;
+        for (j = 0; j < record->n_caps; j++) {
+            guint32 offset = device_cache_blob_add (blob, offsets,
+                                                    g_ptr_array_index (table->caps, record->caps[j]));
+            g_array_append_val (refs, offset);
+        }
+
+        entry->first_property = refs->len;
+        entry->n_properties = g_strv_length (record->properties);
+        for (j = 0; j < entry->n_properties; j++) {
+            guint32 offset = device_cache_blob_add (blob, offsets,
+                                                    record->properties[j]);
+            g_array_append_val (refs, offset);
+        }
+    }
+    /* the blob points into the records */
+    g_hash_table_unref (offsets);
+    g_mutex_unlock (&table->lock);
+
+    header.n_refs = refs->len;
+    base = sizeof (header) + header.n_devices * sizeof (DeviceCacheEntry) +
+           refs->len * sizeof (guint32);
+    for (i = 0; i < header.n_devices; i++) {
+        entries[i].name_offset += base;
+        entries[i].class_offset += base;
+        if (entries[i].launch_line_offset)
+            entries[i].launch_line_offset += base;
+    }
+    for (i = 0; i < refs->len; i++)
+        g_array_index (refs, guint32, i) += base;
+
+    size = base + blob->len;
+    contents = g_malloc (size);
+    memcpy (contents, &header, sizeof (header));
+    memcpy (contents + sizeof (header), entries,
+            header.n_devices * sizeof (DeviceCacheEntry));
+    memcpy (contents + sizeof (header) + header.n_devices * sizeof (DeviceCacheEntry),
+            refs->data, refs->len * sizeof (guint32));
+    memcpy (contents + base, blob->data, blob->len);
+
+    path = device_cache_path ();
+    dir = g_path_get_dirname (path);
+    g_mkdir_with_parents (dir, 0700);
+    if (!g_file_set_contents (path, contents, size, &error)) {
+        GST_WARNING ("Could not write device cache %s: %s", path, error->message);
+        g_clear_error (&error);
+    } else {
+        GST_DEBUG ("Wrote device cache with %u devices", header.n_devices);
+    }
+
+    g_free (dir);
+    g_free (path);
+    g_free (contents);
+    g_free (entries);
+    g_array_free (refs, TRUE);
+    g_byte_array_unref (blob);
 }
 
 static void
-device_removed (GstDevice * device)
+print_device (DeviceRecord * record, GPtrArray * caps_strings, gboolean modified)
+{
+    gchar **p;
+    guint i;
+
+    GST_INFO ("Device %s: %s, class %s", modified ? "modified" : "found",
+              record->name, record->device_class);
+    for (i = 0; i < caps_strings->len; i++)
+        GST_DEBUG ("\t%s %s", (i == 0) ? "caps  :" : "       ",
+                   (gchar *) g_ptr_array_index (caps_strings, i));
+    for (p = record->properties; p[0] != NULL; p += 2)
+        GST_DEBUG ("\t%s = %s", p[0], p[1]);
+}
+
+/* Record @device in the device table, in place of @replaces if given.
+ * Returns whether that changed it. */
+static gboolean
+device_found (CustomData * data, GstDevice * device, GstDevice * replaces)
+{
+    gboolean modified = replaces != NULL;
+    GPtrArray *caps_strings = g_ptr_array_new ();
+    DeviceRecord *record = device_record_new (device, caps_strings);
+    gboolean changed;
+
+    print_device (record, caps_strings, modified);
+    changed = device_table_insert (&data->devices, record, caps_strings,
+                                   replaces);
+    g_ptr_array_free (caps_strings, TRUE);
+
+    return changed;
+}
+
+static gboolean
+device_removed (CustomData * data, GstDevice * device)
 {
     gchar *name;
+    gint id;
 
     name = gst_device_get_display_name (device);
+    id = device_table_remove (&data->devices, device);
 
-    GST_INFO ("Device removed:\n");
-    GST_INFO ("\tname  : %s\n", name);
+    GST_INFO ("Device removed: %s, id %d", name, id);
 
     g_free (name);
+
+    return id >= 0;
+}
+
+/* A bounce keeps the flush pushed back for at most this many windows */
+#define COALESCE_MAX_WINDOWS 4
+
+/* The queued messages for one endpoint. DEVICE_CHANGED hands over a new
+ * GstDevice each time, so the entry follows the latest one while
+ * @replaces keeps the object the table knew it by before the burst. */
+typedef struct
+{
+    GstDevice *device;
+    GstDevice *replaces;
+    GstMessageType type;
+} PendingEvent;
+
+static void
+pending_event_free (PendingEvent * event)
+{
+    gst_object_unref (event->device);
+    if (event->replaces)
+        gst_object_unref (event->replaces);
+    g_free (event);
+}
+
+/* @replaces is the device a DEVICE_CHANGED @device took the place of */
+static gboolean
+device_event_apply (CustomData * data, GstDevice * device, GstDevice * replaces,
+                    GstMessageType type)
+{
+    switch (type) {
+        case GST_MESSAGE_DEVICE_ADDED:
+            return device_found (data, device, NULL);
+        case GST_MESSAGE_DEVICE_REMOVED:
+            return device_removed (data, device);
+        case GST_MESSAGE_DEVICE_CHANGED:
+            return device_found (data, device, replaces);
+        default:
+            return FALSE;
+    }
+}
+
+/* Apply the net effect of the queued messages: only the last one per
+ * endpoint counts. Removals only detach their records first, so a device
+ * that drops out and comes back within the burst keeps its id and, if
+ * nothing about it changed, is not reported at all. Java is told once. */
+static gboolean
+device_events_flush (DevMonApp * app)
+{
+    DeviceTable *table = &app->data->devices;
+    gboolean changed = FALSE;
+    guint i, removed;
+
+    app->flush_id = 0;
+
+    for (i = 0; i < app->pending_order->len; i++) {
+        PendingEvent *event = g_ptr_array_index (app->pending_order, i);
+
+        if (event->type == GST_MESSAGE_DEVICE_REMOVED)
+            device_table_detach (table, event->replaces ? event->replaces
+                                                        : event->device);
+    }
+
+    for (i = 0; i < app->pending_order->len; i++) {
+        PendingEvent *event = g_ptr_array_index (app->pending_order, i);
+
+        if (event->type != GST_MESSAGE_DEVICE_REMOVED
+            && device_found (app->data, event->device, event->replaces))
+            changed = TRUE;
+    }
+
+    removed = device_table_remove_cached (table);
+
+    GST_INFO ("Coalesced %u device messages for %u devices%s",
+              app->n_pending_messages, app->pending_order->len,
+              (changed || removed) ? "" : ", nothing changed");
+
+    g_hash_table_remove_all (app->pending);
+    g_ptr_array_set_size (app->pending_order, 0);
+    app->n_pending_messages = 0;
+
+    if (changed || removed)
+        notify_devices_changed (app->data);
+
+    return G_SOURCE_REMOVE;
+}
+
+/* Hold @type for @device until no message came for a window, or a few
+ * windows after the burst began. A DEVICE_CHANGED is merged into the entry
+ * of the @changed_device it supersedes, which then goes by @device. */
+static void
+device_event_queue (DevMonApp * app, GstDevice * device,
+                    GstDevice * changed_device, GstMessageType type)
+{
+    gint64 now = g_get_monotonic_time ();
+    GstDevice *key = changed_device ? changed_device : device;
+    PendingEvent *event = g_hash_table_lookup (app->pending, key);
+
+    if (event == NULL) {
+        event = g_new (PendingEvent, 1);
+        event->device = gst_object_ref (device);
+        event->replaces = changed_device ? gst_object_ref (changed_device)
+                                         : NULL;
+        event->type = type;
+        g_ptr_array_add (app->pending_order, event);
+        g_hash_table_insert (app->pending, device, event);
+    } else {
+        if (key != device) {
+            g_hash_table_remove (app->pending, key);
+            gst_object_replace ((GstObject **) & event->device,
+                                GST_OBJECT (device));
+            g_hash_table_insert (app->pending, device, event);
+        }
+        /* A device added within the burst is still new to Java */
+        if (type != GST_MESSAGE_DEVICE_CHANGED
+            || event->type != GST_MESSAGE_DEVICE_ADDED)
+            event->type = type;
+    }
+    app->n_pending_messages++;
+
+    if (app->flush_id == 0) {
+        app->burst_start = now;
+    } else if (now - app->burst_start <
+               (gint64) app->coalesce_ms * 1000 * COALESCE_MAX_WINDOWS) {
+        g_source_remove (app->flush_id);
+        app->flush_id = 0;
+    }
+
+    if (app->flush_id == 0)
+        app->flush_id = g_timeout_add (app->coalesce_ms,
+                                       (GSourceFunc) device_events_flush, app);
 }
 
 static gboolean
 bus_msg_handler (GstBus * bus, GstMessage * msg, gpointer user_data)
 {
-    GstDevice *device;
+    DevMonApp *app = user_data;
+    GstMessageType type = GST_MESSAGE_TYPE (msg);
+    GstDevice *device, *changed_device = NULL;
 
-    switch (GST_MESSAGE_TYPE (msg)) {
+    switch (type) {
         case GST_MESSAGE_DEVICE_ADDED:
             gst_message_parse_device_added (msg, &device);
-            print_device (device, FALSE);
-            gst_object_unref (device);
             break;
         case GST_MESSAGE_DEVICE_REMOVED:
             gst_message_parse_device_removed (msg, &device);
-            device_removed (device);
-            gst_object_unref (device);
             break;
         case GST_MESSAGE_DEVICE_CHANGED:
-            gst_message_parse_device_changed (msg, &device, NULL);
-            print_device (device, TRUE);
-            gst_object_unref (device);
+            /* @device is a new object, the provider swaps @changed_device
+             * out for it */
+            gst_message_parse_device_changed (msg, &device, &changed_device);
             break;
         default:
             GST_INFO ("%s message\n", GST_MESSAGE_TYPE_NAME (msg));
-            break;
+            return TRUE;
     }
 
+    if (app->coalesce_ms > 0)
+        device_event_queue (app, device, changed_device, type);
+    else if (device_event_apply (app->data, device, changed_device, type))
+        notify_devices_changed (app->data);
+    gst_object_unref (device);
+    if (changed_device)
+        gst_object_unref (changed_device);
+
     return TRUE;
 }
 
+/* Most providers that are started at once */
+#define PROVIDER_START_THREADS 4
+
+typedef struct
+{
+    gchar *name;
+    GstDeviceProvider *provider;
+    gboolean started;
+    gdouble seconds;
+} ProviderStart;
+
+static void
+provider_start_func (gpointer task_data, gpointer user_data)
+{
+    ProviderStart *start = task_data;
+    GTimer *timer = g_timer_new ();
+
+    start->started = gst_device_provider_start (start->provider);
+    start->seconds = g_timer_elapsed (timer, NULL);
+    g_timer_destroy (timer);
+}
+
+/* Start the monitor's providers a few at a time instead of one after the
+ * other. Providers are per-factory singletons that count their starts, so
+ * gst_device_monitor_start() afterwards finds them running; the extra
+ * starts are dropped again with providers_release(). The result stays in
+ * the monitor's provider order. */
+static GArray *
+providers_start (GstDeviceMonitor * monitor)
+{
+    GArray *starts = g_array_new (FALSE, TRUE, sizeof (ProviderStart));
+    gchar **names = gst_device_monitor_get_providers (monitor);
+    GThreadPool *pool;
+    guint i;
+
+    for (i = 0; names != NULL && names[i] != NULL; i++) {
+        GstDeviceProviderFactory *factory;
+        ProviderStart start = { NULL, };
+
+        factory = gst_device_provider_factory_find (names[i]);
+        if (!factory)
+            continue;
+        start.provider = gst_device_provider_factory_get (factory);
+        gst_object_unref (factory);
+        if (!start.provider)
+            continue;
+        start.name = g_strdup (names[i]);
+        g_array_append_val (starts, start);
+    }
+    g_strfreev (names);
+
+    if (starts->len == 0)
+        return starts;
+
+    pool = g_thread_pool_new (provider_start_func, NULL,
+                              MIN (starts->len, PROVIDER_START_THREADS), FALSE, NULL);
+    for (i = 0; i < starts->len; i++)
+        g_thread_pool_push (pool, &g_array_index (starts, ProviderStart, i),
+                            NULL);
+    /* waits for all of them */
+    g_thread_pool_free (pool, FALSE, TRUE);
+
+    return starts;
+}
+
+static void
+providers_release (GArray * starts)
+{
+    guint i;
+
+    for (i = 0; i < starts->len; i++) {
+        ProviderStart *start = &g_array_index (starts, ProviderStart, i);
+
+        if (start->started)
+            gst_device_provider_stop (start->provider);
+        gst_object_unref (start->provider);
+        g_free (start->name);
+    }
+    g_array_free (starts, TRUE);
+}
+
 static gboolean
 quit_loop (GMainLoop * loop)
 {
@@ -412,6 +1339,14 @@ quit_loop (GMainLoop * loop)
     return G_SOURCE_REMOVE;
 }
 
+/* Take back the cached devices shown at startup when no probe follows */
+static void
+cached_devices_withdraw (CustomData * data)
+{
+    if (device_table_remove_cached (&data->devices) > 0)
+        notify_devices_changed (data);
+}
+
 /* Main method for the native code. This is executed on its own thread. */
 static void *
 app_function (void *userdata)
@@ -486,6 +1421,8 @@ app_function (void *userdata)
     gchar **arg, **args = NULL;
     gboolean follow = FALSE;
     gboolean include_hidden = FALSE;
+    gboolean serial_start = FALSE;
+    gint coalesce_ms = 150;
     GOptionContext *ctx;
     GOptionEntry options[] = {
             {"version", 0, 0, G_OPTION_ARG_NONE, &print_version,
@@ -495,12 +1432,33 @@ app_function (void *userdata)
                                                                             "for devices to added/removed."), NULL},
             {"include-hidden", 'i', 0, G_OPTION_ARG_NONE, &include_hidden,
                                                                          N_("Include devices from hidden device providers."), NULL},
+            {"serial-start", 0, 0, G_OPTION_ARG_NONE, &serial_start,
+                                                                         N_("Start device providers one after the other."), NULL},
+            {"coalesce", 'c', 0, G_OPTION_ARG_INT, &coalesce_ms,
+                                                                         N_("Merge device changes coming within this many milliseconds "
+                                                                            "of each other, 0 to handle each on its own."), "MS"},
             {G_OPTION_REMAINING, 0, 0, G_OPTION_ARG_STRING_ARRAY, &args, NULL},
             {NULL}
     };
     GTimer *timer;
     DevMonApp app;
     GstBus *bus;
+    CustomData *data = (CustomData *) userdata;
+    GList *devices, *l;
+    GArray *starts = NULL;
+    GString *message;
+    gboolean have_filters = FALSE;
+    gboolean changed = FALSE;
+    guint i, n_cached;
+    gint64 start_time = g_get_monotonic_time ();
+
+    /* Show what was there last time while the providers come up */
+    n_cached = device_cache_load (&data->devices);
+    if (n_cached > 0) {
+        notify_devices_changed (data);
+        GST_INFO ("Showed %u cached devices after %" G_GINT64_FORMAT " us",
+                  n_cached, g_get_monotonic_time () - start_time);
+    }
 
     setlocale (LC_ALL, "");
 
@@ -520,6 +1478,7 @@ app_function (void *userdata)
         GST_ERROR ("Error initializing: %s\n", GST_STR_NULL (err->message));
         g_option_context_free (ctx);
         g_clear_error (&err);
+        cached_devices_withdraw (data);
         return 1;
     }
     g_option_context_free (ctx);
@@ -537,10 +1496,18 @@ app_function (void *userdata)
         GST_INFO ("%s\n", GST_PACKAGE_ORIGIN);
         g_free (version_str);
 
+        cached_devices_withdraw (data);
         return 0;
     }
 
-    app.loop = g_main_loop_new (NULL, FALSE);
+    app.loop = g_main_loop_ref (data->main_loop);
+    app.data = data;
+    app.coalesce_ms = MAX (coalesce_ms, 0);
+    app.pending = g_hash_table_new (NULL, NULL);
+    app.pending_order =
+            g_ptr_array_new_with_free_func ((GDestroyNotify) pending_event_free);
+    app.n_pending_messages = 0;
+    app.flush_id = 0;
     app.monitor = gst_device_monitor_new ();
     gst_device_monitor_set_show_all_devices (app.monitor, include_hidden);
 
@@ -561,6 +1528,7 @@ app_function (void *userdata)
                     GST_WARNING ("Couldn't parse device filter caps '%s'", filters[1]);
             }
             gst_device_monitor_add_filter (app.monitor, filters[0], caps);
+            have_filters = TRUE;
             if (caps)
                 gst_caps_unref (caps);
             g_strfreev (filters);
@@ -572,12 +1540,55 @@ app_function (void *userdata)
 
     timer = g_timer_new ();
 
+    if (!serial_start) {
+        /* what gst_device_monitor_start() would do, but the providers have
+         * to exist before it is called */
+        if (!have_filters)
+            gst_device_monitor_add_filter (app.monitor, NULL, NULL);
+        starts = providers_start (app.monitor);
+    }
+
     if (!gst_device_monitor_start (app.monitor)) {
         GST_ERROR ("Failed to start device monitor!\n");
+        if (starts)
+            providers_release (starts);
+        cached_devices_withdraw (data);
         return -1;
     }
 
     GST_INFO ("Took %.2f seconds", g_timer_elapsed (timer, NULL));
+    message = g_string_new (NULL);
+    g_string_printf (message, "Probed devices in %.2f seconds",
+                     g_timer_elapsed (timer, NULL));
+    for (i = 0; starts != NULL && i < starts->len; i++) {
+        ProviderStart *start = &g_array_index (starts, ProviderStart, i);
+
+        GST_INFO ("%s %s in %.2f seconds", start->name,
+                  start->started ? "started" : "failed to start", start->seconds);
+        g_string_append_printf (message, "\n  %s: %.2f s%s", start->name,
+                                start->seconds, start->started ? "" : " (failed)");
+    }
+    set_ui_message (message->str, data);
+    g_string_free (message, TRUE);
+
+    /* the monitor holds its own start on the providers now */
+    if (starts)
+        providers_release (starts);
+
+    /* The initial device list, later changes come in as bus messages. Java
+     * only hears about it if it differs from the cached one. */
+    devices = gst_device_monitor_get_devices (app.monitor);
+    for (l = devices; l != NULL; l = l->next) {
+        if (device_found (data, l->data, NULL))
+            changed = TRUE;
+        gst_object_unref (l->data);
+    }
+    g_list_free (devices);
+    if (device_table_remove_cached (&data->devices) > 0)
+        changed = TRUE;
+    if (changed || n_cached == 0)
+        notify_devices_changed (data);
+    device_cache_save (&data->devices);
 
     if (!follow) {
         /* Consume all the messages pending on the bus and exit */
@@ -589,6 +1600,16 @@ app_function (void *userdata)
 
     g_main_loop_run (app.loop);
 
+    if (app.flush_id) {
+        g_source_remove (app.flush_id);
+        device_events_flush (&app);
+    }
+    g_hash_table_unref (app.pending);
+    g_ptr_array_unref (app.pending_order);
+
+    /* keep launch lines worked out and devices that came and went */
+    device_cache_save (&data->devices);
+
     gst_device_monitor_stop (app.monitor);
     gst_object_unref (app.monitor);
 
@@ -616,6 +1637,15 @@ gst_native_init (JNIEnv * env, jobject thiz)
   GST_DEBUG ("Created CustomData at %p", data);
   data->app = (*env)->NewGlobalRef (env, thiz);
   GST_DEBUG ("Created GlobalRef for app object at %p", data->app);
+  data->ring.mem = g_malloc (OUTPUT_RING_SLOTS * OUTPUT_SLOT_SIZE);
+  g_mutex_init (&data->ring.lock);
+  g_cond_init (&data->ring.cond);
+  device_table_init (&data->devices);
+  /* Created before the thread, as finalize may want to quit it while the
+   * providers are still being probed. The monitor's watches and timeouts
+   * go to the default context, so the loop runs that. */
+  data->context = g_main_context_ref (g_main_context_default ());
+  data->main_loop = g_main_loop_new (data->context, FALSE);
   pthread_create (&gst_app_thread, NULL, &app_function, data);
 }
 
@@ -624,12 +1654,32 @@ static void
 gst_native_finalize (JNIEnv * env, jobject thiz)
 {
   CustomData *data = GET_CUSTOM_DATA (env, thiz, custom_data_field_id);
+  GSource *quit_source;
+
   if (!data)
     return;
+  g_mutex_lock (&data->ring.lock);
+  data->ring.closed = TRUE;
+  g_cond_broadcast (&data->ring.cond);
+  g_mutex_unlock (&data->ring.lock);
   GST_DEBUG ("Quitting main loop...");
-  g_main_loop_quit (data->main_loop);
+  /* Dispatched by the loop itself, so a quit asked for before
+   * g_main_loop_run() is not lost */
+  quit_source = g_idle_source_new ();
+  g_source_set_priority (quit_source, G_PRIORITY_HIGH);
+  g_source_set_callback (quit_source, (GSourceFunc) quit_loop,
+      g_main_loop_ref (data->main_loop), (GDestroyNotify) g_main_loop_unref);
+  g_source_attach (quit_source, data->context);
   GST_DEBUG ("Waiting for thread to finish...");
   pthread_join (gst_app_thread, NULL);
+  g_source_destroy (quit_source);
+  g_source_unref (quit_source);
+  g_main_loop_unref (data->main_loop);
+  g_main_context_unref (data->context);
+  device_table_clear (&data->devices);
+  g_mutex_clear (&data->ring.lock);
+  g_cond_clear (&data->ring.cond);
+  g_free (data->ring.mem);
   GST_DEBUG ("Deleting GlobalRef for app object at %p", data->app);
   (*env)->DeleteGlobalRef (env, data->app);
   GST_DEBUG ("Freeing CustomData at %p", data);
@@ -660,6 +1710,311 @@ gst_native_pause (JNIEnv * env, jobject thiz)
   gst_element_set_state (data->pipeline, GST_STATE_PAUSED);
 }
 
+/* Wrap the output ring in direct ByteBuffers. Java calls this once and keeps
+ * the array; messages go through it from then on. */
+static jobjectArray
+gst_native_get_output_buffers (JNIEnv * env, jobject thiz)
+{
+  CustomData *data = GET_CUSTOM_DATA (env, thiz, custom_data_field_id);
+  jclass byte_buffer_class;
+  jobjectArray buffers;
+  guint i;
+
+  if (!data)
+    return NULL;
+
+  byte_buffer_class = (*env)->FindClass (env, "java/nio/ByteBuffer");
+  buffers = (*env)->NewObjectArray (env, OUTPUT_RING_SLOTS, byte_buffer_class,
+      NULL);
+  for (i = 0; i < OUTPUT_RING_SLOTS; i++) {
+    jobject buffer = (*env)->NewDirectByteBuffer (env,
+        data->ring.mem + i * OUTPUT_SLOT_SIZE, OUTPUT_SLOT_SIZE);
+    (*env)->SetObjectArrayElement (env, buffers, i, buffer);
+    (*env)->DeleteLocalRef (env, buffer);
+  }
+  (*env)->DeleteLocalRef (env, byte_buffer_class);
+
+  g_atomic_int_set (&data->ring.registered, TRUE);
+  return buffers;
+}
+
+/* Java is done reading a slot named by onBytesReady() */
+static void
+gst_native_release_buffer (JNIEnv * env, jobject thiz, jint slot)
+{
+  CustomData *data = GET_CUSTOM_DATA (env, thiz, custom_data_field_id);
+  if (!data || slot < 0 || slot >= OUTPUT_RING_SLOTS)
+    return;
+  g_mutex_lock (&data->ring.lock);
+  data->ring.busy[slot] = FALSE;
+  g_cond_signal (&data->ring.cond);
+  g_mutex_unlock (&data->ring.lock);
+}
+
+/* Output channel benchmark: the same message sent to Java through
+ * NewStringUTF() + an upcall, and through the ring + an upcall. The Java
+ * receivers consume the text synchronously, onBenchmarkBytes() decoding
+ * it and releasing the slot like onBytesReady() does, so each side is timed
+ * for the full round trip. */
+#define BENCHMARK_OUTPUT_SIZE (4 * 1024)
+#define BENCHMARK_OUTPUT_WARMUP 100
+
+/* What the device list looks like, repeated to a typical message size */
+static gchar *
+benchmark_output_message (CustomData * data)
+{
+  GString *base = g_string_new (NULL);
+  GString *str;
+  guint i;
+
+  g_mutex_lock (&data->devices.lock);
+  for (i = 0; i < data->devices.records->len; i++) {
+    DeviceRecord *record = g_ptr_array_index (data->devices.records, i);
+
+    g_string_append_printf (base, "%s (%s)\n", record->name,
+        GST_STR_NULL (record->device_class));
+  }
+  for (i = 0; i < data->devices.caps->len; i++)
+    g_string_append_printf (base, "  %s\n",
+        (gchar *) g_ptr_array_index (data->devices.caps, i));
+  g_mutex_unlock (&data->devices.lock);
+
+  if (base->len == 0)
+    g_string_append (base, "Probed devices in 0.00 seconds\n");
+
+  str = g_string_sized_new (BENCHMARK_OUTPUT_SIZE + base->len);
+  while (str->len < BENCHMARK_OUTPUT_SIZE)
+    g_string_append_len (str, base->str, base->len);
+  g_string_free (base, TRUE);
+
+  return g_string_free (str, FALSE);
+}
+
+static gint64
+benchmark_output_string (JNIEnv * env, CustomData * data,
+    const gchar * message, guint n)
+{
+  gint64 start = g_get_monotonic_time ();
+  guint i;
+
+  for (i = 0; i < n; i++) {
+    jstring jmessage = (*env)->NewStringUTF (env, message);
+
+    (*env)->CallVoidMethod (env, data->app, on_benchmark_string_method_id,
+        jmessage);
+    if ((*env)->ExceptionCheck (env)) {
+      GST_ERROR ("Failed to call Java method");
+      (*env)->ExceptionClear (env);
+    }
+    (*env)->DeleteLocalRef (env, jmessage);
+  }
+
+  return g_get_monotonic_time () - start;
+}
+
+/* -1 if Java has not taken the buffers */
+static gint64
+benchmark_output_bytes (JNIEnv * env, CustomData * data,
+    const gchar * message, guint n)
+{
+  gint64 start = g_get_monotonic_time ();
+  guint i;
+
+  for (i = 0; i < n; i++)
+    if (!set_ui_message_bytes (env, message, data,
+            on_benchmark_bytes_method_id))
+      return -1;
+
+  return g_get_monotonic_time () - start;
+}
+
+/* Must not be called on the UI thread: the ring may be waiting for slots
+ * that queued onBytesReady() runnables release there. */
+static jstring
+gst_native_benchmark_output (JNIEnv * env, jobject thiz, jint messages)
+{
+  CustomData *data = GET_CUSTOM_DATA (env, thiz, custom_data_field_id);
+  gchar *message, *report;
+  gint64 string_us, bytes_us;
+  guint n = MAX (messages, 1);
+  gsize len;
+  jstring result;
+
+  if (!data)
+    return NULL;
+
+  message = benchmark_output_message (data);
+  len = strlen (message);
+
+  /* warm up both paths, the JIT and the allocator */
+  benchmark_output_string (env, data, message, BENCHMARK_OUTPUT_WARMUP);
+  if (benchmark_output_bytes (env, data, message,
+          BENCHMARK_OUTPUT_WARMUP) < 0) {
+    g_free (message);
+    return (*env)->NewStringUTF (env,
+        "Output buffers are not registered, nothing to compare");
+  }
+
+  string_us = benchmark_output_string (env, data, message, n);
+  bytes_us = benchmark_output_bytes (env, data, message, n);
+
+  report = g_strdup_printf ("Output channel, %u messages of %" G_GSIZE_FORMAT
+      " bytes:\n  NewStringUTF + setMessage: %.2f us each\n"
+      "  ByteBuffer ring + decode: %.2f us each", n, len,
+      (gdouble) string_us / n, (gdouble) bytes_us / n);
+  GST_INFO ("%s", report);
+  result = (*env)->NewStringUTF (env, report);
+
+  g_free (report);
+  g_free (message);
+  return result;
+}
+
+/* Records of the devices whose classes include all of @class_mask, all of
+ * them for 0 */
+static jobjectArray
+gst_native_get_devices (JNIEnv * env, jobject thiz, jint class_mask)
+{
+  CustomData *data = GET_CUSTOM_DATA (env, thiz, custom_data_field_id);
+  DeviceTable *table;
+  GPtrArray *matches;
+  jclass string_class;
+  jobjectArray devices;
+  guint i;
+
+  if (!data)
+    return NULL;
+
+  table = &data->devices;
+  matches = g_ptr_array_new ();
+  string_class = (*env)->FindClass (env, "java/lang/String");
+
+  g_mutex_lock (&table->lock);
+  for (i = 0; i < table->records->len; i++) {
+    DeviceRecord *record = g_ptr_array_index (table->records, i);
+
+    if ((record->classes & class_mask) == (guint) class_mask)
+      g_ptr_array_add (matches, record);
+  }
+
+  devices = (*env)->NewObjectArray (env, matches->len, device_class, NULL);
+  for (i = 0; devices != NULL && i < matches->len; i++) {
+    DeviceRecord *record = g_ptr_array_index (matches, i);
+    guint j, n_properties = g_strv_length (record->properties);
+    jstring name, device_class_name;
+    jintArray caps;
+    jobjectArray properties;
+    jobject device;
+
+    name = (*env)->NewStringUTF (env, record->name);
+    device_class_name = (*env)->NewStringUTF (env, record->device_class);
+    caps = (*env)->NewIntArray (env, record->n_caps);
+    (*env)->SetIntArrayRegion (env, caps, 0, record->n_caps,
+        (const jint *) record->caps);
+    properties = (*env)->NewObjectArray (env, n_properties, string_class,
+        NULL);
+    for (j = 0; j < n_properties; j++) {
+      jstring property = (*env)->NewStringUTF (env, record->properties[j]);
+      (*env)->SetObjectArrayElement (env, properties, j, property);
+      (*env)->DeleteLocalRef (env, property);
+    }
+
+    device = (*env)->NewObject (env, device_class, device_constructor_id,
+        record->id, record->classes, name, device_class_name, caps, properties);
+    (*env)->SetObjectArrayElement (env, devices, i, device);
+
+    (*env)->DeleteLocalRef (env, device);
+    (*env)->DeleteLocalRef (env, properties);
+    (*env)->DeleteLocalRef (env, caps);
+    (*env)->DeleteLocalRef (env, device_class_name);
+    (*env)->DeleteLocalRef (env, name);
+  }
+  g_mutex_unlock (&table->lock);
+
+  (*env)->DeleteLocalRef (env, string_class);
+  g_ptr_array_free (matches, TRUE);
+  return devices;
+}
+
+/* Caps strings for handles from Device.caps, null for unknown handles */
+static jobjectArray
+gst_native_get_caps (JNIEnv * env, jobject thiz, jintArray handles)
+{
+  CustomData *data = GET_CUSTOM_DATA (env, thiz, custom_data_field_id);
+  DeviceTable *table;
+  jobjectArray caps;
+  jint *ids;
+  jsize i, n;
+
+  if (!data || !handles)
+    return NULL;
+
+  table = &data->devices;
+  n = (*env)->GetArrayLength (env, handles);
+  ids = (*env)->GetIntArrayElements (env, handles, NULL);
+  caps = (*env)->NewObjectArray (env, n,
+      (*env)->FindClass (env, "java/lang/String"), NULL);
+
+  g_mutex_lock (&table->lock);
+  for (i = 0; caps != NULL && i < n; i++) {
+    jstring str;
+
+    if (ids[i] < 0 || (guint) ids[i] >= table->caps->len)
+      continue;
+    str = (*env)->NewStringUTF (env, g_ptr_array_index (table->caps, ids[i]));
+    (*env)->SetObjectArrayElement (env, caps, i, str);
+    (*env)->DeleteLocalRef (env, str);
+  }
+  g_mutex_unlock (&table->lock);
+
+  (*env)->ReleaseIntArrayElements (env, handles, ids, JNI_ABORT);
+  return caps;
+}
+
+/* gst-launch line for a device. It is only worked out on first request as
+ * that means creating the element. */
+static jstring
+gst_native_get_launch_line (JNIEnv * env, jobject thiz, jint id)
+{
+  CustomData *data = GET_CUSTOM_DATA (env, thiz, custom_data_field_id);
+  DeviceTable *table;
+  DeviceRecord *record;
+  GstDevice *device = NULL;
+  gchar *line = NULL;
+  jstring result = NULL;
+
+  if (!data)
+    return NULL;
+
+  table = &data->devices;
+
+  g_mutex_lock (&table->lock);
+  record = device_table_lookup (table, id);
+  if (record != NULL && record->launch_line != NULL)
+    line = g_strdup (record->launch_line);
+  else if (record != NULL && record->device != NULL)
+    device = gst_object_ref (record->device);
+  g_mutex_unlock (&table->lock);
+
+  if (device != NULL) {
+    line = get_launch_line (device);
+
+    g_mutex_lock (&table->lock);
+    record = device_table_lookup (table, id);
+    if (line != NULL && record != NULL && record->device == device
+        && record->launch_line == NULL)
+      record->launch_line = g_strdup (line);
+    g_mutex_unlock (&table->lock);
+
+    gst_object_unref (device);
+  }
+
+  if (line != NULL)
+    result = (*env)->NewStringUTF (env, line);
+  g_free (line);
+  return result;
+}
+
 /* Static class initializer: retrieve method and field IDs */
 static jboolean
 gst_native_class_init (JNIEnv * env, jclass klass)
@@ -668,11 +2023,33 @@ gst_native_class_init (JNIEnv * env, jclass klass)
       (*env)->GetFieldID (env, klass, "native_custom_data", "J");
   set_message_method_id =
       (*env)->GetMethodID (env, klass, "setMessage", "(Ljava/lang/String;)V");
+  on_bytes_ready_method_id =
+      (*env)->GetMethodID (env, klass, "onBytesReady", "(III)V");
+  on_benchmark_string_method_id =
+      (*env)->GetMethodID (env, klass, "onBenchmarkString",
+      "(Ljava/lang/String;)V");
+  on_benchmark_bytes_method_id =
+      (*env)->GetMethodID (env, klass, "onBenchmarkBytes", "(III)V");
   on_gstreamer_initialized_method_id =
       (*env)->GetMethodID (env, klass, "onGStreamerInitialized", "()V");
+  on_devices_changed_method_id =
+      (*env)->GetMethodID (env, klass, "onDevicesChanged", "()V");
+
+  device_class = (*env)->FindClass (env,
+      "org/freedesktop/gstreamer/tools/device_monitor/DeviceMonitor$Device");
+  if (device_class) {
+    jclass local = device_class;
+
+    device_class = (*env)->NewGlobalRef (env, local);
+    (*env)->DeleteLocalRef (env, local);
+    device_constructor_id = (*env)->GetMethodID (env, device_class, "<init>",
+        "(IILjava/lang/String;Ljava/lang/String;[I[Ljava/lang/String;)V");
+  }
 
   if (!custom_data_field_id || !set_message_method_id
-      || !on_gstreamer_initialized_method_id) {
+      || !on_bytes_ready_method_id || !on_gstreamer_initialized_method_id
+      || !on_benchmark_string_method_id || !on_benchmark_bytes_method_id
+      || !on_devices_changed_method_id || !device_constructor_id) {
     /* We emit this message through the Android log instead of the GStreamer log because the later
      * has not been initialized yet.
      */
@@ -689,7 +2066,18 @@ static JNINativeMethod native_methods[] = {
   {"nativeFinalize", "()V", (void *) gst_native_finalize},
   {"nativePlay", "()V", (void *) gst_native_play},
   {"nativePause", "()V", (void *) gst_native_pause},
-  {"nativeClassInit", "()Z", (void *) gst_native_class_init}
+  {"nativeClassInit", "()Z", (void *) gst_native_class_init},
+  {"nativeGetOutputBuffers", "()[Ljava/nio/ByteBuffer;",
+      (void *) gst_native_get_output_buffers},
+  {"nativeReleaseBuffer", "(I)V", (void *) gst_native_release_buffer},
+  {"nativeGetDevices",
+      "(I)[Lorg/freedesktop/gstreamer/tools/device_monitor/DeviceMonitor$Device;",
+      (void *) gst_native_get_devices},
+  {"nativeGetCaps", "([I)[Ljava/lang/String;", (void *) gst_native_get_caps},
+  {"nativeGetLaunchLine", "(I)Ljava/lang/String;",
+      (void *) gst_native_get_launch_line},
+  {"nativeBenchmarkOutput", "(I)Ljava/lang/String;",
+      (void *) gst_native_benchmark_output}
 };
 
 /* Library initializer */
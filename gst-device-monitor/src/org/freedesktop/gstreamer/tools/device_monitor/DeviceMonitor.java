@@ -5,22 +5,67 @@ import android.os.Bundle;
 import android.util.Log;
 import android.view.View;
 import android.view.View.OnClickListener;
+import android.view.View.OnLongClickListener;
 import android.widget.ImageButton;
 import android.widget.TextView;
 import android.widget.Toast;
 
+import java.nio.ByteBuffer;
+import java.nio.charset.Charset;
+
 import org.freedesktop.gstreamer.GStreamer;
 import org.freedesktop.gstreamer.tools.device_monitor.R;
 
 public class DeviceMonitor extends Activity {
+    // One device found by the native device monitor, see nativeGetDevices()
+    public static class Device {
+        public static final int CLASS_SOURCE = 1 << 0;
+        public static final int CLASS_SINK   = 1 << 1;
+        public static final int CLASS_AUDIO  = 1 << 2;
+        public static final int CLASS_VIDEO  = 1 << 3;
+        public static final int CLASS_CAMERA = 1 << 4;
+
+        public final int id;             // Stable while the device is present
+        public final int classes;        // CLASS_* bits
+        public final String name;
+        public final String deviceClass; // As reported, e.g. "Video/Source"
+        public final int[] caps;         // Caps handles, resolve with nativeGetCaps()
+        public final String[] properties; // Key, value, key, value, ...
+
+        Device(int id, int classes, String name, String deviceClass, int[] caps, String[] properties) {
+            this.id = id;
+            this.classes = classes;
+            this.name = name;
+            this.deviceClass = deviceClass;
+            this.caps = caps;
+            this.properties = properties;
+        }
+    }
+
     private native void nativeInit();     // Initialize native code, build pipeline, etc
     private native void nativeFinalize(); // Destroy pipeline and shutdown native code
     private native void nativePlay();     // Set pipeline to PLAYING
     private native void nativePause();    // Set pipeline to PAUSED
     private static native boolean nativeClassInit(); // Initialize native class: cache Method IDs for callbacks
+    private native ByteBuffer[] nativeGetOutputBuffers(); // Native memory messages are passed in
+    private native void nativeReleaseBuffer(int slot);    // Hand a message buffer back to native code
+    private native Device[] nativeGetDevices(int classMask); // Devices having all classes in the mask, 0 for all
+    private native String[] nativeGetCaps(int[] handles); // Caps strings for Device.caps handles
+    private native String nativeGetLaunchLine(int id);    // gst-launch line for a device, made on first call
+    private native String nativeBenchmarkOutput(int messages); // Times both message paths, off the UI thread
     private long native_custom_data;      // Native code will use this to keep private data
 
     private boolean is_playing_desired;   // Whether the user asked to go to PLAYING
+    private ByteBuffer[] output_buffers;  // Shared with native code, see onBytesReady()
+    private boolean is_destroyed;         // Message buffers are gone once native code is finalized
+    private String last_message = "";     // Status line shown above the device list
+    private String device_list = "";      // Formatted by onDevicesChanged()
+    private Thread benchmark_thread;      // Running nativeBenchmarkOutput(), if any
+    private int benchmark_sink;           // Keeps what the benchmark receives in use
+
+    private static final int BENCHMARK_MESSAGES = 2000;
+
+    private static final Charset UTF8 = Charset.forName("UTF-8");
 
     // Called when the activity is first created.
     @Override
@@ -55,6 +100,24 @@ public class DeviceMonitor extends Activity {
             }
         });
 
+        // Long press on the message compares the two ways messages reach Java
+        TextView message = (TextView) this.findViewById(R.id.textview_message);
+        message.setOnLongClickListener(new OnLongClickListener() {
+            public boolean onLongClick(View v) {
+                if (benchmark_thread != null && benchmark_thread.isAlive())
+                    return true;
+                benchmark_thread = new Thread(new Runnable() {
+                    public void run() {
+                        String report = nativeBenchmarkOutput(BENCHMARK_MESSAGES);
+                        if (report != null)
+                            setMessage(report);
+                    }
+                });
+                benchmark_thread.start();
+                return true;
+            }
+        });
+
         if (savedInstanceState != null) {
             is_playing_desired = savedInstanceState.getBoolean("playing");
             Log.i ("GStreamer", "Activity created. Saved state is playing:" + is_playing_desired);
@@ -68,6 +131,7 @@ public class DeviceMonitor extends Activity {
         this.findViewById(R.id.button_stop).setEnabled(false);
 
         nativeInit();
+        output_buffers = nativeGetOutputBuffers();
     }
 
     protected void onSaveInstanceState (Bundle outState) {
@@ -76,6 +140,14 @@ public class DeviceMonitor extends Activity {
     }
 
     protected void onDestroy() {
+        is_destroyed = true;
+        if (benchmark_thread != null) {
+            try {
+                benchmark_thread.join();
+            } catch (InterruptedException e) {
+                Thread.currentThread().interrupt();
+            }
+        }
         nativeFinalize();
         super.onDestroy();
     }
@@ -85,11 +157,63 @@ public class DeviceMonitor extends Activity {
         final TextView tv = (TextView) this.findViewById(R.id.textview_message);
         runOnUiThread (new Runnable() {
           public void run() {
-            tv.setText(message);
+            last_message = message;
+            tv.setText(last_message + device_list);
           }
         });
     }
 
+    // Called from native code. The message sits in one of the shared buffers and is decoded in place;
+    // the buffer must be released afterwards so native code can fill it again.
+    private void onBytesReady(final int slot, final int offset, final int length) {
+        final TextView tv = (TextView) this.findViewById(R.id.textview_message);
+        runOnUiThread (new Runnable() {
+          public void run() {
+            if (is_destroyed)
+              return;
+            ByteBuffer view = output_buffers[slot].duplicate();
+            view.limit(offset + length);
+            view.position(offset);
+            String message = UTF8.decode(view).toString();
+            nativeReleaseBuffer(slot);
+            last_message = message;
+            tv.setText(last_message + device_list);
+          }
+        });
+    }
+
+    // Called from native code whenever a device is added, removed or changed.
+    private void onDevicesChanged() {
+        final TextView tv = (TextView) this.findViewById(R.id.textview_message);
+        runOnUiThread (new Runnable() {
+          public void run() {
+            if (is_destroyed)
+              return;
+            StringBuilder sb = new StringBuilder();
+            for (Device device : nativeGetDevices(0))
+              sb.append("\n").append(device.name).append(" (").append(device.deviceClass).append(")");
+            device_list = sb.toString();
+            tv.setText(last_message + device_list);
+          }
+        });
+    }
+
+    // Called from native code by nativeBenchmarkOutput(), on its thread: the jstring path.
+    private void onBenchmarkString(String message) {
+        benchmark_sink += message.length();
+    }
+
+    // Called from native code by nativeBenchmarkOutput(), on its thread: the buffer path, decoding
+    // and releasing the slot as onBytesReady() does.
+    private void onBenchmarkBytes(int slot, int offset, int length) {
+        ByteBuffer view = output_buffers[slot].duplicate();
+        view.limit(offset + length);
+        view.position(offset);
+        String message = UTF8.decode(view).toString();
+        nativeReleaseBuffer(slot);
+        benchmark_sink += message.length();
+    }
+
     // Called from native code. Native code calls this once it has created its pipeline and
     // the main loop is running, so it is ready to accept commands.
     private void onGStreamerInitialized () {
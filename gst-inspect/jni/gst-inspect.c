@@ -20,7 +20,7 @@
 #include <glib/gprintf.h>
 #ifdef G_OS_UNIX
 #   include <unistd.h>
-#   include <sys/wait.h>
+#   include <dlfcn.h>
 #endif
 
 
@@ -29,15 +29,6 @@
 //
 #define g_print(...) n_print(__VA_ARGS__)
 
-/* "R" : support color
- * "X" : do not clear the screen when leaving the pager
- * "F" : skip the pager if content fit into the screen
- *
- * Don't forget to update the manpage gst-inspect-1.0.1
- * after changing this default.
- */
-#define DEFAULT_LESS_OPTS "RXF"
-
 gboolean colored_output = TRUE;
 
 typedef enum
@@ -48,12 +39,6 @@ typedef enum
 
 SortType sort_output = SORT_TYPE_NAME;
 
-#ifdef G_OS_UNIX
-static const gchar DEFAULT_PAGER[] = "less";
-GPid child_pid = -1;
-#endif
-GMainLoop *loop = NULL;
-
 /* Console colors */
 
 /* Escape values for colors */
@@ -101,20 +86,135 @@ GMainLoop *loop = NULL;
 #define FEATURE_RANK_COLOR    (colored_output? CYAN : "")
 #define FEATURE_PROTO_COLOR   (colored_output? BRYELLOW : "")
 
-static char *_name = NULL;
-static int indent = 0;
-static GString *message_str = NULL;
+/* Size at which buffered output is handed on to the UI */
+#define OUTPUT_CHUNK_SIZE (8 * 1024)
+
+typedef void (*InspectFlushFunc) (const gchar * text, gsize len,
+    gpointer user_data);
+
+/* Destination of n_print(). When flush is set, complete lines are passed on
+ * every chunk_size bytes and dropped from str, so the memory held stays
+ * bounded however much a request prints. */
+typedef struct _InspectOutput
+{
+  GString *str;
+  gsize chunk_size;
+  InspectFlushFunc flush;
+  gpointer user_data;
+} InspectOutput;
+
+/* Per thread, so that print_element_list() can introspect elements on a
+ * pool of threads, each printing into a buffer of its own */
+static __thread char *_name = NULL;
+static __thread int indent = 0;
+static __thread InspectOutput *output = NULL;
+
+/* Set while --benchmark-print measures n_print() */
+typedef struct
+{
+  gboolean legacy;              /* Format through gst_info_strdup_vprintf() */
+  guint64 calls;
+  guint64 allocs;               /* Heap allocations made by n_print() */
+} NPrintStats;
+
+static __thread NPrintStats *n_print_stats = NULL;
+
+/* Also set by --benchmark-print, so every element is introspected again */
+static __thread gboolean inspect_index_bypass = FALSE;
+
+static void
+capture_str_free (GString * str)
+{
+  g_string_free (str, TRUE);
+}
+
+/* Reused for capturing print_element_info() output, one per thread and
+ * released along with the thread */
+static GPrivate capture_str = G_PRIVATE_INIT ((GDestroyNotify) capture_str_free);
+
+/* Threads print_element_list() introspects elements on, 0 for one per CPU */
+static gint inspect_jobs = 0;
+
+/* Parts of print_element_info() output, see --sections */
+typedef enum
+{
+  INSPECT_SECTION_DETAILS = (1 << 0),
+  INSPECT_SECTION_HIERARCHY = (1 << 1),
+  INSPECT_SECTION_INTERFACES = (1 << 2),
+  INSPECT_SECTION_PAD_TEMPLATES = (1 << 3),
+  INSPECT_SECTION_CLOCKING = (1 << 4),
+  INSPECT_SECTION_URI_HANDLER = (1 << 5),
+  INSPECT_SECTION_PADS = (1 << 6),
+  INSPECT_SECTION_PROPERTIES = (1 << 7),
+  INSPECT_SECTION_SIGNALS = (1 << 8),
+  INSPECT_SECTION_CHILDREN = (1 << 9),
+  INSPECT_SECTION_PRESETS = (1 << 10),
+  INSPECT_SECTION_ALL = (1 << 11) - 1
+} InspectSections;
+
+static guint inspect_sections = INSPECT_SECTION_ALL;
+
+/* Set by --json, element details are then printed by print_element_json() */
+static gboolean inspect_json = FALSE;
+
+/* Requests are serviced in order on the app_function thread. Every new
+ * request bumps latest_request_id, so a walk still running for an older id
+ * notices it has been superseded and bails out (see inspect_cancelled()). */
+static gint running_request_id = 0;
+static gint latest_request_id = 0;
 
 static int print_element_info (GstPluginFeature * feature,
                                gboolean print_names);
 static int print_typefind_info (GstPluginFeature * feature,
                                 gboolean print_names);
 static int print_tracer_info (GstPluginFeature * feature, gboolean print_names);
+static int print_device_provider_info (GstPluginFeature * feature,
+                                       gboolean print_names);
 
 #define push_indent() push_indent_n(1)
 #define pop_indent() push_indent_n(-1)
 #define pop_indent_n(n) push_indent_n(-n)
 
+/* Hand the buffered output to the flush function. Unless @all is set only
+ * whole lines are passed on, the incomplete tail stays for the next round. */
+static void
+inspect_output_flush (InspectOutput * out, gboolean all)
+{
+    gsize len = out->str->len;
+
+    if (len == 0 || out->flush == NULL)
+        return;
+
+    if (!all) {
+        const gchar *nl = g_strrstr_len (out->str->str, len, "\n");
+
+        if (nl != NULL) {
+            len = nl - out->str->str + 1;
+        } else if (len < 4 * out->chunk_size) {
+            /* keep waiting for the end of the line */
+            return;
+        } else {
+            /* absurdly long line, cut it on a character boundary */
+            len = g_utf8_find_prev_char (out->str->str,
+                    out->str->str + len) - out->str->str;
+            if (len == 0)
+                return;
+        }
+    }
+
+    out->flush (out->str->str, len, out->user_data);
+    g_string_erase (out->str, 0, len);
+}
+
+/* Append text that was already formatted, e.g. replayed from a cache */
+static void
+inspect_output_write (const gchar * text, gsize len)
+{
+    g_string_append_len (output->str, text, len);
+    if (output->str->len >= output->chunk_size)
+        inspect_output_flush (output, FALSE);
+}
+
 static void
 push_indent_n (int n)
 {
@@ -122,6 +222,51 @@ push_indent_n (int n)
     indent += n;
 }
 
+/* Two spaces per indentation level; deeper levels take several copies */
+static const gchar indent_spaces[] =
+    "                                                                ";
+
+static void
+n_print_legacy (const char *format, va_list args)
+{
+    gchar *str = gst_info_strdup_vprintf (format, args);
+
+    if (!str)
+        return;
+    n_print_stats->allocs++;
+    output->str = g_string_append(output->str, str);
+    g_free (str);
+}
+
+/* Format straight into the spare room of output->str. Nothing here needs
+ * the GStreamer printf extensions, and only a line that doesn't fit makes
+ * the buffer grow. */
+static void
+n_print_valist (const char *format, va_list args)
+{
+    GString *str = output->str;
+    gsize start = str->len;
+    va_list args2;
+    gint len;
+
+    G_VA_COPY (args2, args);
+    len = g_vsnprintf (str->str + start, str->allocated_len - start, format,
+        args2);
+    va_end (args2);
+
+    if (len < 0) {
+        str->str[start] = '\0';
+        return;
+    }
+    if ((gsize) len < str->allocated_len - start) {
+        str->len += len;
+        return;
+    }
+
+    g_string_set_size (str, start + len);
+    g_vsnprintf (str->str + start, len + 1, format, args);
+}
+
 /* *INDENT-OFF* */
 G_GNUC_PRINTF (1, 2)
 /* *INDENT-ON* */
@@ -130,32 +275,41 @@ static void
 n_print (const char *format, ...)
 {
     va_list args;
-    int i;
-    gchar *str;
+    gsize pad = 2 * indent;
+    gsize allocated_len = output->str->allocated_len;
 #if 0
     if (_name)
         g_print ("%s", _name);
-
-    for (i = 0; i < indent; ++i)
-        g_print ("  ");
-#else
-    for (i = 0; i < indent; ++i)
-        message_str = g_string_append(message_str, "  ");
 #endif
 
+    while (pad > 0) {
+        gsize n = MIN (pad, sizeof (indent_spaces) - 1);
+
+        g_string_append_len (output->str, indent_spaces, n);
+        pad -= n;
+    }
+
     va_start (args, format);
-    str = gst_info_strdup_vprintf (format, args);
+    if (G_UNLIKELY (n_print_stats != NULL && n_print_stats->legacy))
+        n_print_legacy (format, args);
+    else
+        n_print_valist (format, args);
     va_end (args);
 
-    if (!str)
-        return;
+    if (G_UNLIKELY (n_print_stats != NULL)) {
+        n_print_stats->calls++;
+        if (output->str->allocated_len != allocated_len)
+            n_print_stats->allocs++;
+    }
 
-#if 0
-    g_print ("%s", str);
-#else
-    message_str = g_string_append(message_str, str);
-#endif
-    g_free (str);
+    if (output->str->len >= output->chunk_size)
+        inspect_output_flush (output, FALSE);
+}
+
+static gboolean
+inspect_cancelled (void)
+{
+    return running_request_id != g_atomic_int_get (&latest_request_id);
 }
 
 static gboolean
@@ -363,358 +517,491 @@ sort_gparamspecs (GParamSpec ** a, GParamSpec ** b)
     return g_strcmp0 (g_param_spec_get_name (*a), g_param_spec_get_name (*b));
 }
 
-/* obj will be NULL if we're printing properties of pad template pads */
+/* Print one property: name and blurb, flags, type and @value */
 static void
-print_object_properties_info (GObject * obj, GObjectClass * obj_class,
-                              const gchar * desc)
+print_property_info (GObjectClass * obj_class, GParamSpec * param,
+                     const GValue * value, gboolean readable)
 {
-    GParamSpec **property_specs;
-    guint num_properties, i;
-    gboolean readable;
     gboolean first_flag;
 
-    property_specs = g_object_class_list_properties (obj_class, &num_properties);
-    g_qsort_with_data (property_specs, num_properties, sizeof (gpointer),
-                       (GCompareDataFunc) sort_gparamspecs, NULL);
+    n_print ("%s%-20s%s: %s%s%s\n", PROP_NAME_COLOR,
+             g_param_spec_get_name (param), RESET_COLOR, PROP_VALUE_COLOR,
+             g_param_spec_get_blurb (param), RESET_COLOR);
 
-    n_print ("%s%s%s:\n", HEADING_COLOR, desc, RESET_COLOR);
-
-    push_indent ();
-
-    for (i = 0; i < num_properties; i++) {
-        GValue value = { 0, };
-        GParamSpec *param = property_specs[i];
-        GType owner_type = param->owner_type;
+    push_indent_n (11);
 
-        /* We're printing pad properties */
-        if (obj == NULL && (owner_type == G_TYPE_OBJECT
-                            || owner_type == GST_TYPE_OBJECT || owner_type == GST_TYPE_PAD))
-            continue;
+    first_flag = TRUE;
+    n_print ("%sflags%s: ", PROP_ATTR_NAME_COLOR, RESET_COLOR);
+    if (readable) {
+        g_print ("%s%s%s%s", (first_flag) ? "" : ", ", PROP_ATTR_VALUE_COLOR,
+                 _("readable"), RESET_COLOR);
+        first_flag = FALSE;
+    }
+    if (param->flags & G_PARAM_WRITABLE) {
+        g_print ("%s%s%s%s", (first_flag) ? "" : ", ", PROP_ATTR_VALUE_COLOR,
+                 _("writable"), RESET_COLOR);
+        first_flag = FALSE;
+    }
+    if (param->flags & G_PARAM_DEPRECATED) {
+        g_print ("%s%s%s%s", (first_flag) ? "" : ", ", PROP_ATTR_VALUE_COLOR,
+                 _("deprecated"), RESET_COLOR);
+        first_flag = FALSE;
+    }
+    if (param->flags & GST_PARAM_CONTROLLABLE) {
+        g_print (", %s%s%s", PROP_ATTR_VALUE_COLOR, _("controllable"),
+                 RESET_COLOR);
+        first_flag = FALSE;
+    }
+    if (param->flags & GST_PARAM_CONDITIONALLY_AVAILABLE) {
+        g_print (", %s%s%s", PROP_ATTR_VALUE_COLOR, _("conditionally available"),
+                 RESET_COLOR);
+        first_flag = FALSE;
+    }
+    if (param->flags & GST_PARAM_MUTABLE_PLAYING) {
+        g_print (", %s%s%s", PROP_ATTR_VALUE_COLOR,
+                 _("changeable in NULL, READY, PAUSED or PLAYING state"), RESET_COLOR);
+    } else if (param->flags & GST_PARAM_MUTABLE_PAUSED) {
+        g_print (", %s%s%s", PROP_ATTR_VALUE_COLOR,
+                 _("changeable only in NULL, READY or PAUSED state"), RESET_COLOR);
+    } else if (param->flags & GST_PARAM_MUTABLE_READY) {
+        g_print (", %s%s%s", PROP_ATTR_VALUE_COLOR,
+                 _("changeable only in NULL or READY state"), RESET_COLOR);
+    }
+    if (param->flags & ~KNOWN_PARAM_FLAGS) {
+        g_print ("%s0x%s%0x%s", (first_flag) ? "" : ", ", PROP_ATTR_VALUE_COLOR,
+                 param->flags & ~KNOWN_PARAM_FLAGS, RESET_COLOR);
+    }
+    g_print ("\n");
 
-        g_value_init (&value, param->value_type);
+    switch (G_VALUE_TYPE (value)) {
+        case G_TYPE_STRING:
+        {
+            const char *string_val = g_value_get_string (value);
 
-        n_print ("%s%-20s%s: %s%s%s\n", PROP_NAME_COLOR,
-                 g_param_spec_get_name (param), RESET_COLOR, PROP_VALUE_COLOR,
-                 g_param_spec_get_blurb (param), RESET_COLOR);
+            n_print ("%sString%s. ", DATATYPE_COLOR, RESET_COLOR);
 
-        push_indent_n (11);
+            if (string_val == NULL)
+                g_print ("%sDefault%s: %snull%s", PROP_ATTR_NAME_COLOR, RESET_COLOR,
+                         PROP_ATTR_VALUE_COLOR, RESET_COLOR);
+            else
+                g_print ("%sDefault%s: %s\"%s\"%s", PROP_ATTR_NAME_COLOR, RESET_COLOR,
+                         PROP_ATTR_VALUE_COLOR, string_val, RESET_COLOR);
+            break;
+        }
+        case G_TYPE_BOOLEAN:
+        {
+            gboolean bool_val = g_value_get_boolean (value);
 
-        first_flag = TRUE;
-        n_print ("%sflags%s: ", PROP_ATTR_NAME_COLOR, RESET_COLOR);
-        readable = ! !(param->flags & G_PARAM_READABLE);
-        if (readable && obj != NULL) {
-            g_object_get_property (obj, param->name, &value);
-        } else {
-            /* if we can't read the property value, assume it's set to the default
-             * (which might not be entirely true for sub-classes, but that's an
-             * unlikely corner-case anyway) */
-            g_param_value_set_default (param, &value);
+            n_print ("%sBoolean%s. %sDefault%s: %s%s%s", DATATYPE_COLOR,
+                     RESET_COLOR, PROP_ATTR_NAME_COLOR, RESET_COLOR,
+                     PROP_ATTR_VALUE_COLOR, bool_val ? "true" : "false", RESET_COLOR);
+            break;
         }
-        if (readable) {
-            g_print ("%s%s%s%s", (first_flag) ? "" : ", ", PROP_ATTR_VALUE_COLOR,
-                     _("readable"), RESET_COLOR);
-            first_flag = FALSE;
+        case G_TYPE_ULONG:
+        {
+            GParamSpecULong *pulong = G_PARAM_SPEC_ULONG (param);
+
+            n_print
+                    ("%sUnsigned Long%s. %sRange%s: %s%lu - %lu%s %sDefault%s: %s%lu%s ",
+                     DATATYPE_COLOR, RESET_COLOR, PROP_ATTR_NAME_COLOR, RESET_COLOR,
+                     PROP_ATTR_VALUE_COLOR, pulong->minimum, pulong->maximum,
+                     RESET_COLOR, PROP_ATTR_NAME_COLOR, RESET_COLOR,
+                     PROP_ATTR_VALUE_COLOR, g_value_get_ulong (value), RESET_COLOR);
+
+            GST_ERROR ("%s: property '%s' of type ulong: consider changing to "
+                       "uint/uint64", G_OBJECT_CLASS_NAME (obj_class),
+                       g_param_spec_get_name (param));
+            break;
         }
-        if (param->flags & G_PARAM_WRITABLE) {
-            g_print ("%s%s%s%s", (first_flag) ? "" : ", ", PROP_ATTR_VALUE_COLOR,
-                     _("writable"), RESET_COLOR);
-            first_flag = FALSE;
+        case G_TYPE_LONG:
+        {
+            GParamSpecLong *plong = G_PARAM_SPEC_LONG (param);
+
+            n_print ("%sLong%s. %sRange%s: %s%ld - %ld%s %sDefault%s: %s%ld%s ",
+                     DATATYPE_COLOR, RESET_COLOR, PROP_ATTR_NAME_COLOR, RESET_COLOR,
+                     PROP_ATTR_VALUE_COLOR, plong->minimum, plong->maximum, RESET_COLOR,
+                     PROP_ATTR_NAME_COLOR, RESET_COLOR, PROP_ATTR_VALUE_COLOR,
+                     g_value_get_long (value), RESET_COLOR);
+
+            GST_ERROR ("%s: property '%s' of type long: consider changing to "
+                       "int/int64", G_OBJECT_CLASS_NAME (obj_class),
+                       g_param_spec_get_name (param));
+            break;
         }
-        if (param->flags & G_PARAM_DEPRECATED) {
-            g_print ("%s%s%s%s", (first_flag) ? "" : ", ", PROP_ATTR_VALUE_COLOR,
-                     _("deprecated"), RESET_COLOR);
-            first_flag = FALSE;
+        case G_TYPE_UINT:
+        {
+            GParamSpecUInt *puint = G_PARAM_SPEC_UINT (param);
+
+            n_print
+                    ("%sUnsigned Integer%s. %sRange%s: %s%u - %u%s %sDefault%s: %s%u%s ",
+                     DATATYPE_COLOR, RESET_COLOR, PROP_ATTR_NAME_COLOR, RESET_COLOR,
+                     PROP_ATTR_VALUE_COLOR, puint->minimum, puint->maximum, RESET_COLOR,
+                     PROP_ATTR_NAME_COLOR, RESET_COLOR, PROP_ATTR_VALUE_COLOR,
+                     g_value_get_uint (value), RESET_COLOR);
+            break;
         }
-        if (param->flags & GST_PARAM_CONTROLLABLE) {
-            g_print (", %s%s%s", PROP_ATTR_VALUE_COLOR, _("controllable"),
-                     RESET_COLOR);
-            first_flag = FALSE;
+        case G_TYPE_INT:
+        {
+            GParamSpecInt *pint = G_PARAM_SPEC_INT (param);
+
+            n_print ("%sInteger%s. %sRange%s: %s%d - %d%s %sDefault%s: %s%d%s ",
+                     DATATYPE_COLOR, RESET_COLOR, PROP_ATTR_NAME_COLOR, RESET_COLOR,
+                     PROP_ATTR_VALUE_COLOR, pint->minimum, pint->maximum, RESET_COLOR,
+                     PROP_ATTR_NAME_COLOR, RESET_COLOR, PROP_ATTR_VALUE_COLOR,
+                     g_value_get_int (value), RESET_COLOR);
+            break;
         }
-        if (param->flags & GST_PARAM_CONDITIONALLY_AVAILABLE) {
-            g_print (", %s%s%s", PROP_ATTR_VALUE_COLOR, _("conditionally available"),
+        case G_TYPE_UINT64:
+        {
+            GParamSpecUInt64 *puint64 = G_PARAM_SPEC_UINT64 (param);
+
+            n_print ("%sUnsigned Integer64%s. %sRange%s: %s%" G_GUINT64_FORMAT " - "
+                                                                               "%" G_GUINT64_FORMAT "%s %sDefault%s: %s%" G_GUINT64_FORMAT "%s ",
+                    DATATYPE_COLOR, RESET_COLOR, PROP_ATTR_NAME_COLOR, RESET_COLOR,
+                    PROP_ATTR_VALUE_COLOR, puint64->minimum, puint64->maximum,
+                    RESET_COLOR, PROP_ATTR_NAME_COLOR, RESET_COLOR,
+                    PROP_ATTR_VALUE_COLOR, g_value_get_uint64 (value), RESET_COLOR);
+            break;
+        }
+        case G_TYPE_INT64:
+        {
+            GParamSpecInt64 *pint64 = G_PARAM_SPEC_INT64 (param);
+
+            n_print ("%sInteger64%s. %sRange%s: %s%" G_GINT64_FORMAT " - %"
+            G_GINT64_FORMAT "%s %sDefault%s: %s%" G_GINT64_FORMAT "%s ",
+                    DATATYPE_COLOR, RESET_COLOR, PROP_ATTR_NAME_COLOR, RESET_COLOR,
+                    PROP_ATTR_VALUE_COLOR, pint64->minimum, pint64->maximum,
+                    RESET_COLOR, PROP_ATTR_NAME_COLOR, RESET_COLOR,
+                    PROP_ATTR_VALUE_COLOR, g_value_get_int64 (value), RESET_COLOR);
+            break;
+        }
+        case G_TYPE_FLOAT:
+        {
+            GParamSpecFloat *pfloat = G_PARAM_SPEC_FLOAT (param);
+
+            n_print ("%sFloat%s. %sRange%s: %s%15.7g - %15.7g%s "
+                     "%sDefault%s: %s%15.7g%s ", DATATYPE_COLOR, RESET_COLOR,
+                     PROP_ATTR_NAME_COLOR, RESET_COLOR, PROP_ATTR_VALUE_COLOR,
+                     pfloat->minimum, pfloat->maximum, RESET_COLOR, PROP_ATTR_NAME_COLOR,
+                     RESET_COLOR, PROP_ATTR_VALUE_COLOR, g_value_get_float (value),
                      RESET_COLOR);
-            first_flag = FALSE;
-        }
-        if (param->flags & GST_PARAM_MUTABLE_PLAYING) {
-            g_print (", %s%s%s", PROP_ATTR_VALUE_COLOR,
-                     _("changeable in NULL, READY, PAUSED or PLAYING state"), RESET_COLOR);
-        } else if (param->flags & GST_PARAM_MUTABLE_PAUSED) {
-            g_print (", %s%s%s", PROP_ATTR_VALUE_COLOR,
-                     _("changeable only in NULL, READY or PAUSED state"), RESET_COLOR);
-        } else if (param->flags & GST_PARAM_MUTABLE_READY) {
-            g_print (", %s%s%s", PROP_ATTR_VALUE_COLOR,
-                     _("changeable only in NULL or READY state"), RESET_COLOR);
-        }
-        if (param->flags & ~KNOWN_PARAM_FLAGS) {
-            g_print ("%s0x%s%0x%s", (first_flag) ? "" : ", ", PROP_ATTR_VALUE_COLOR,
-                     param->flags & ~KNOWN_PARAM_FLAGS, RESET_COLOR);
+            break;
         }
-        g_print ("\n");
+        case G_TYPE_DOUBLE:
+        {
+            GParamSpecDouble *pdouble = G_PARAM_SPEC_DOUBLE (param);
+
+            n_print ("%sDouble%s. %sRange%s: %s%15.7g - %15.7g%s "
+                     "%sDefault%s: %s%15.7g%s ", DATATYPE_COLOR, RESET_COLOR,
+                     PROP_ATTR_NAME_COLOR, RESET_COLOR, PROP_ATTR_VALUE_COLOR,
+                     pdouble->minimum, pdouble->maximum, RESET_COLOR,
+                     PROP_ATTR_NAME_COLOR, RESET_COLOR, PROP_ATTR_VALUE_COLOR,
+                     g_value_get_double (value), RESET_COLOR);
+            break;
+        }
+        case G_TYPE_CHAR:
+        case G_TYPE_UCHAR:
+            GST_ERROR ("%s: property '%s' of type char: consider changing to "
+                       "int/string", G_OBJECT_CLASS_NAME (obj_class),
+                       g_param_spec_get_name (param));
+            /* fall through */
+        default:
+            if (param->value_type == GST_TYPE_CAPS) {
+                const GstCaps *caps = gst_value_get_caps (value);
+
+                if (!caps)
+                    n_print ("%sCaps%s (NULL)", DATATYPE_COLOR, RESET_COLOR);
+                else {
+                    print_caps (caps, "                           ");
+                }
+            } else if (G_IS_PARAM_SPEC_ENUM (param)) {
+                GEnumValue *values;
+                guint j = 0;
+                gint enum_value;
+                const gchar *value_nick = "";
+
+                values = G_ENUM_CLASS (g_type_class_ref (param->value_type))->values;
+                enum_value = g_value_get_enum (value);
+
+                while (values[j].value_name) {
+                    if (values[j].value == enum_value)
+                        value_nick = values[j].value_nick;
+                    j++;
+                }
 
-        switch (G_VALUE_TYPE (&value)) {
-            case G_TYPE_STRING:
-            {
-                const char *string_val = g_value_get_string (&value);
+                n_print ("%sEnum \"%s\"%s %sDefault%s: %s%d, \"%s\"%s",
+                         DATATYPE_COLOR, g_type_name (G_VALUE_TYPE (value)), RESET_COLOR,
+                         PROP_ATTR_NAME_COLOR, RESET_COLOR, PROP_ATTR_VALUE_COLOR,
+                         enum_value, value_nick, RESET_COLOR);
 
-                n_print ("%sString%s. ", DATATYPE_COLOR, RESET_COLOR);
+                j = 0;
+                while (values[j].value_name) {
+                    g_print ("\n");
+                    n_print ("   %s(%d)%s: %s%-16s%s - %s%s%s",
+                             PROP_ATTR_NAME_COLOR, values[j].value, RESET_COLOR,
+                             PROP_ATTR_VALUE_COLOR, values[j].value_nick, RESET_COLOR,
+                             DESC_COLOR, values[j].value_name, RESET_COLOR);
+                    j++;
+                }
+                /* g_type_class_unref (ec); */
+            } else if (G_IS_PARAM_SPEC_FLAGS (param)) {
+                GParamSpecFlags *pflags = G_PARAM_SPEC_FLAGS (param);
+                GFlagsValue *vals;
+                gchar *cur;
 
-                if (string_val == NULL)
-                    g_print ("%sDefault%s: %snull%s", PROP_ATTR_NAME_COLOR, RESET_COLOR,
-                             PROP_ATTR_VALUE_COLOR, RESET_COLOR);
-                else
-                    g_print ("%sDefault%s: %s\"%s\"%s", PROP_ATTR_NAME_COLOR, RESET_COLOR,
-                             PROP_ATTR_VALUE_COLOR, string_val, RESET_COLOR);
-                break;
-            }
-            case G_TYPE_BOOLEAN:
-            {
-                gboolean bool_val = g_value_get_boolean (&value);
+                vals = pflags->flags_class->values;
 
-                n_print ("%sBoolean%s. %sDefault%s: %s%s%s", DATATYPE_COLOR,
-                         RESET_COLOR, PROP_ATTR_NAME_COLOR, RESET_COLOR,
-                         PROP_ATTR_VALUE_COLOR, bool_val ? "true" : "false", RESET_COLOR);
-                break;
-            }
-            case G_TYPE_ULONG:
-            {
-                GParamSpecULong *pulong = G_PARAM_SPEC_ULONG (param);
-
-                n_print
-                        ("%sUnsigned Long%s. %sRange%s: %s%lu - %lu%s %sDefault%s: %s%lu%s ",
-                         DATATYPE_COLOR, RESET_COLOR, PROP_ATTR_NAME_COLOR, RESET_COLOR,
-                         PROP_ATTR_VALUE_COLOR, pulong->minimum, pulong->maximum,
-                         RESET_COLOR, PROP_ATTR_NAME_COLOR, RESET_COLOR,
-                         PROP_ATTR_VALUE_COLOR, g_value_get_ulong (&value), RESET_COLOR);
-
-                GST_ERROR ("%s: property '%s' of type ulong: consider changing to "
-                           "uint/uint64", G_OBJECT_CLASS_NAME (obj_class),
-                           g_param_spec_get_name (param));
-                break;
-            }
-            case G_TYPE_LONG:
-            {
-                GParamSpecLong *plong = G_PARAM_SPEC_LONG (param);
+                cur = flags_to_string (vals, g_value_get_flags (value));
 
-                n_print ("%sLong%s. %sRange%s: %s%ld - %ld%s %sDefault%s: %s%ld%s ",
-                         DATATYPE_COLOR, RESET_COLOR, PROP_ATTR_NAME_COLOR, RESET_COLOR,
-                         PROP_ATTR_VALUE_COLOR, plong->minimum, plong->maximum, RESET_COLOR,
+                n_print ("%sFlags \"%s\"%s %sDefault%s: %s0x%08x, \"%s\"%s",
+                         DATATYPE_COLOR, g_type_name (G_VALUE_TYPE (value)), RESET_COLOR,
                          PROP_ATTR_NAME_COLOR, RESET_COLOR, PROP_ATTR_VALUE_COLOR,
-                         g_value_get_long (&value), RESET_COLOR);
+                         g_value_get_flags (value), cur, RESET_COLOR);
 
-                GST_ERROR ("%s: property '%s' of type long: consider changing to "
-                           "int/int64", G_OBJECT_CLASS_NAME (obj_class),
-                           g_param_spec_get_name (param));
-                break;
-            }
-            case G_TYPE_UINT:
-            {
-                GParamSpecUInt *puint = G_PARAM_SPEC_UINT (param);
-
-                n_print
-                        ("%sUnsigned Integer%s. %sRange%s: %s%u - %u%s %sDefault%s: %s%u%s ",
-                         DATATYPE_COLOR, RESET_COLOR, PROP_ATTR_NAME_COLOR, RESET_COLOR,
-                         PROP_ATTR_VALUE_COLOR, puint->minimum, puint->maximum, RESET_COLOR,
-                         PROP_ATTR_NAME_COLOR, RESET_COLOR, PROP_ATTR_VALUE_COLOR,
-                         g_value_get_uint (&value), RESET_COLOR);
-                break;
-            }
-            case G_TYPE_INT:
-            {
-                GParamSpecInt *pint = G_PARAM_SPEC_INT (param);
+                while (vals[0].value_name) {
+                    g_print ("\n");
+                    n_print ("   %s(0x%08x)%s: %s%-16s%s - %s%s%s",
+                             PROP_ATTR_NAME_COLOR, vals[0].value, RESET_COLOR,
+                             PROP_ATTR_VALUE_COLOR, vals[0].value_nick, RESET_COLOR,
+                             DESC_COLOR, vals[0].value_name, RESET_COLOR);
+                    ++vals;
+                }
 
-                n_print ("%sInteger%s. %sRange%s: %s%d - %d%s %sDefault%s: %s%d%s ",
-                         DATATYPE_COLOR, RESET_COLOR, PROP_ATTR_NAME_COLOR, RESET_COLOR,
-                         PROP_ATTR_VALUE_COLOR, pint->minimum, pint->maximum, RESET_COLOR,
-                         PROP_ATTR_NAME_COLOR, RESET_COLOR, PROP_ATTR_VALUE_COLOR,
-                         g_value_get_int (&value), RESET_COLOR);
-                break;
-            }
-            case G_TYPE_UINT64:
-            {
-                GParamSpecUInt64 *puint64 = G_PARAM_SPEC_UINT64 (param);
-
-                n_print ("%sUnsigned Integer64%s. %sRange%s: %s%" G_GUINT64_FORMAT " - "
-                                                                                   "%" G_GUINT64_FORMAT "%s %sDefault%s: %s%" G_GUINT64_FORMAT "%s ",
-                        DATATYPE_COLOR, RESET_COLOR, PROP_ATTR_NAME_COLOR, RESET_COLOR,
-                        PROP_ATTR_VALUE_COLOR, puint64->minimum, puint64->maximum,
-                        RESET_COLOR, PROP_ATTR_NAME_COLOR, RESET_COLOR,
-                        PROP_ATTR_VALUE_COLOR, g_value_get_uint64 (&value), RESET_COLOR);
-                break;
-            }
-            case G_TYPE_INT64:
-            {
-                GParamSpecInt64 *pint64 = G_PARAM_SPEC_INT64 (param);
-
-                n_print ("%sInteger64%s. %sRange%s: %s%" G_GINT64_FORMAT " - %"
-                G_GINT64_FORMAT "%s %sDefault%s: %s%" G_GINT64_FORMAT "%s ",
-                        DATATYPE_COLOR, RESET_COLOR, PROP_ATTR_NAME_COLOR, RESET_COLOR,
-                        PROP_ATTR_VALUE_COLOR, pint64->minimum, pint64->maximum,
-                        RESET_COLOR, PROP_ATTR_NAME_COLOR, RESET_COLOR,
-                        PROP_ATTR_VALUE_COLOR, g_value_get_int64 (&value), RESET_COLOR);
-                break;
-            }
-            case G_TYPE_FLOAT:
-            {
-                GParamSpecFloat *pfloat = G_PARAM_SPEC_FLOAT (param);
+                g_free (cur);
+            } else if (G_IS_PARAM_SPEC_OBJECT (param)) {
+                n_print ("%sObject of type%s %s\"%s\"%s", PROP_VALUE_COLOR,
+                         RESET_COLOR, DATATYPE_COLOR,
+                         g_type_name (param->value_type), RESET_COLOR);
+            } else if (G_IS_PARAM_SPEC_BOXED (param)) {
+                n_print ("%sBoxed pointer of type%s %s\"%s\"%s", PROP_VALUE_COLOR,
+                         RESET_COLOR, DATATYPE_COLOR,
+                         g_type_name (param->value_type), RESET_COLOR);
+                if (param->value_type == GST_TYPE_STRUCTURE) {
+                    const GstStructure *s = gst_value_get_structure (value);
+                    if (s) {
+                        g_print ("\n");
+                        gst_structure_foreach (s, print_field,
+                                               (gpointer) "                           ");
+                    }
+                }
+            } else if (G_IS_PARAM_SPEC_POINTER (param)) {
+                if (param->value_type != G_TYPE_POINTER) {
+                    n_print ("%sPointer of type%s %s\"%s\"%s.", PROP_VALUE_COLOR,
+                             RESET_COLOR, DATATYPE_COLOR, g_type_name (param->value_type),
+                             RESET_COLOR);
+                } else {
+                    n_print ("%sPointer.%s", PROP_VALUE_COLOR, RESET_COLOR);
+                }
+            } else if (param->value_type == G_TYPE_VALUE_ARRAY) {
+                GParamSpecValueArray *pvarray = G_PARAM_SPEC_VALUE_ARRAY (param);
 
-                n_print ("%sFloat%s. %sRange%s: %s%15.7g - %15.7g%s "
-                         "%sDefault%s: %s%15.7g%s ", DATATYPE_COLOR, RESET_COLOR,
-                         PROP_ATTR_NAME_COLOR, RESET_COLOR, PROP_ATTR_VALUE_COLOR,
-                         pfloat->minimum, pfloat->maximum, RESET_COLOR, PROP_ATTR_NAME_COLOR,
-                         RESET_COLOR, PROP_ATTR_VALUE_COLOR, g_value_get_float (&value),
-                         RESET_COLOR);
-                break;
-            }
-            case G_TYPE_DOUBLE:
-            {
-                GParamSpecDouble *pdouble = G_PARAM_SPEC_DOUBLE (param);
+                if (pvarray->element_spec) {
+                    n_print ("%sArray of GValues of type%s %s\"%s\"%s",
+                             PROP_VALUE_COLOR, RESET_COLOR, DATATYPE_COLOR,
+                             g_type_name (pvarray->element_spec->value_type), RESET_COLOR);
+                } else {
+                    n_print ("%sArray of GValues%s", PROP_VALUE_COLOR, RESET_COLOR);
+                }
+            } else if (GST_IS_PARAM_SPEC_FRACTION (param)) {
+                GstParamSpecFraction *pfraction = GST_PARAM_SPEC_FRACTION (param);
 
-                n_print ("%sDouble%s. %sRange%s: %s%15.7g - %15.7g%s "
-                         "%sDefault%s: %s%15.7g%s ", DATATYPE_COLOR, RESET_COLOR,
+                n_print ("%sFraction%s. %sRange%s: %s%d/%d - %d/%d%s "
+                         "%sDefault%s: %s%d/%d%s ", DATATYPE_COLOR, RESET_COLOR,
                          PROP_ATTR_NAME_COLOR, RESET_COLOR, PROP_ATTR_VALUE_COLOR,
-                         pdouble->minimum, pdouble->maximum, RESET_COLOR,
-                         PROP_ATTR_NAME_COLOR, RESET_COLOR, PROP_ATTR_VALUE_COLOR,
-                         g_value_get_double (&value), RESET_COLOR);
-                break;
+                         pfraction->min_num, pfraction->min_den, pfraction->max_num,
+                         pfraction->max_den, RESET_COLOR, PROP_ATTR_NAME_COLOR,
+                         RESET_COLOR, PROP_ATTR_VALUE_COLOR,
+                         gst_value_get_fraction_numerator (value),
+                         gst_value_get_fraction_denominator (value), RESET_COLOR);
+            } else if (param->value_type == GST_TYPE_ARRAY) {
+                GstParamSpecArray *parray = GST_PARAM_SPEC_ARRAY_LIST (param);
+
+                if (parray->element_spec) {
+                    n_print ("%sGstValueArray of GValues of type%s %s\"%s\"%s",
+                             PROP_VALUE_COLOR, RESET_COLOR, DATATYPE_COLOR,
+                             g_type_name (parray->element_spec->value_type), RESET_COLOR);
+                } else {
+                    n_print ("%sGstValueArray of GValues%s", PROP_VALUE_COLOR,
+                             RESET_COLOR);
+                }
+            } else {
+                n_print ("%sUnknown type %ld%s %s\"%s\"%s", PROP_VALUE_COLOR,
+                         (glong) param->value_type, RESET_COLOR, DATATYPE_COLOR,
+                         g_type_name (param->value_type), RESET_COLOR);
             }
-            case G_TYPE_CHAR:
-            case G_TYPE_UCHAR:
-                GST_ERROR ("%s: property '%s' of type char: consider changing to "
-                           "int/string", G_OBJECT_CLASS_NAME (obj_class),
-                           g_param_spec_get_name (param));
-                /* fall through */
-            default:
-                if (param->value_type == GST_TYPE_CAPS) {
-                    const GstCaps *caps = gst_value_get_caps (&value);
+            break;
+    }
+    if (!readable)
+        g_print (" %sWrite only%s\n", PROP_VALUE_COLOR, RESET_COLOR);
+    else
+        g_print ("\n");
 
-                    if (!caps)
-                        n_print ("%sCaps%s (NULL)", DATATYPE_COLOR, RESET_COLOR);
-                    else {
-                        print_caps (caps, "                           ");
-                    }
-                } else if (G_IS_PARAM_SPEC_ENUM (param)) {
-                    GEnumValue *values;
-                    guint j = 0;
-                    gint enum_value;
-                    const gchar *value_nick = "";
-
-                    values = G_ENUM_CLASS (g_type_class_ref (param->value_type))->values;
-                    enum_value = g_value_get_enum (&value);
-
-                    while (values[j].value_name) {
-                        if (values[j].value == enum_value)
-                            value_nick = values[j].value_nick;
-                        j++;
-                    }
+    pop_indent_n (11);
+}
 
-                    n_print ("%sEnum \"%s\"%s %sDefault%s: %s%d, \"%s\"%s",
-                             DATATYPE_COLOR, g_type_name (G_VALUE_TYPE (&value)), RESET_COLOR,
-                             PROP_ATTR_NAME_COLOR, RESET_COLOR, PROP_ATTR_VALUE_COLOR,
-                             enum_value, value_nick, RESET_COLOR);
+/* Formatting a property's type, range and value takes a while, enums and
+ * flags list all their values. Properties are mostly inherited from a few
+ * base classes (GstBaseSrc, GstVideoEncoder, ...) and mostly hold their
+ * default, so the formatted text is kept per GParamSpec, which all the
+ * subclasses of its owner type share, along with the value it shows; an
+ * instance holding a different value is formatted again. Sorted property
+ * lists are kept per class. All for the life of the process. */
+typedef struct
+{
+    gchar *value_str;           /* Serialized value the text shows */
+    gchar *text;
+} PropertyText;
 
-                    j = 0;
-                    while (values[j].value_name) {
-                        g_print ("\n");
-                        n_print ("   %s(%d)%s: %s%-16s%s - %s%s%s",
-                                 PROP_ATTR_NAME_COLOR, values[j].value, RESET_COLOR,
-                                 PROP_ATTR_VALUE_COLOR, values[j].value_nick, RESET_COLOR,
-                                 DESC_COLOR, values[j].value_name, RESET_COLOR);
-                        j++;
-                    }
-                    /* g_type_class_unref (ec); */
-                } else if (G_IS_PARAM_SPEC_FLAGS (param)) {
-                    GParamSpecFlags *pflags = G_PARAM_SPEC_FLAGS (param);
-                    GFlagsValue *vals;
-                    gchar *cur;
+typedef struct
+{
+    GParamSpec **specs;         /* Sorted by name */
+    guint n_specs;
+} PropertyList;
 
-                    vals = pflags->flags_class->values;
+static GMutex property_lock;
+static GHashTable *property_texts = NULL;  /* "pspec:indent:colors" -> PropertyText */
+static GHashTable *property_lists = NULL;  /* Class GType -> PropertyList */
 
-                    cur = flags_to_string (vals, g_value_get_flags (&value));
+static void
+property_text_free (PropertyText * text)
+{
+    g_free (text->value_str);
+    g_free (text->text);
+    g_free (text);
+}
 
-                    n_print ("%sFlags \"%s\"%s %sDefault%s: %s0x%08x, \"%s\"%s",
-                             DATATYPE_COLOR, g_type_name (G_VALUE_TYPE (&value)), RESET_COLOR,
-                             PROP_ATTR_NAME_COLOR, RESET_COLOR, PROP_ATTR_VALUE_COLOR,
-                             g_value_get_flags (&value), cur, RESET_COLOR);
+/* What the formatted text depends on in @value, "" if only on its type,
+ * NULL if it can't be told */
+static gchar *
+property_value_key (GParamSpec * param, const GValue * value)
+{
+    if (G_IS_PARAM_SPEC_OBJECT (param) || G_IS_PARAM_SPEC_POINTER (param)
+        || param->value_type == G_TYPE_VALUE_ARRAY
+        || param->value_type == GST_TYPE_ARRAY)
+        return g_strdup ("");
+    /* structures and caps are printed in full */
+    if (G_IS_PARAM_SPEC_BOXED (param) && param->value_type != GST_TYPE_STRUCTURE
+        && param->value_type != GST_TYPE_CAPS)
+        return g_strdup ("");
+    if (G_VALUE_HOLDS_STRING (value))
+        return g_strdup_printf ("%c%s", g_value_get_string (value) ? 's' : 'n',
+                                GST_STR_NULL (g_value_get_string (value)));
+    return gst_value_serialize (value);
+}
 
-                    while (vals[0].value_name) {
-                        g_print ("\n");
-                        n_print ("   %s(0x%08x)%s: %s%-16s%s - %s%s%s",
-                                 PROP_ATTR_NAME_COLOR, vals[0].value, RESET_COLOR,
-                                 PROP_ATTR_VALUE_COLOR, vals[0].value_nick, RESET_COLOR,
-                                 DESC_COLOR, vals[0].value_name, RESET_COLOR);
-                        ++vals;
-                    }
+/* Sorted properties of @obj_class, owned by the cache */
+static GParamSpec **
+list_properties_sorted (GObjectClass * obj_class, guint * n_specs)
+{
+    PropertyList *list;
+
+    g_mutex_lock (&property_lock);
+    if (property_lists == NULL)
+        property_lists = g_hash_table_new (NULL, NULL);
+    list = g_hash_table_lookup (property_lists,
+                                GSIZE_TO_POINTER (G_OBJECT_CLASS_TYPE (obj_class)));
+    if (list == NULL) {
+        list = g_new0 (PropertyList, 1);
+        list->specs = g_object_class_list_properties (obj_class, &list->n_specs);
+        g_qsort_with_data (list->specs, list->n_specs, sizeof (gpointer),
+                           (GCompareDataFunc) sort_gparamspecs, NULL);
+        g_hash_table_insert (property_lists,
+                             GSIZE_TO_POINTER (G_OBJECT_CLASS_TYPE (obj_class)), list);
+    }
+    g_mutex_unlock (&property_lock);
 
-                    g_free (cur);
-                } else if (G_IS_PARAM_SPEC_OBJECT (param)) {
-                    n_print ("%sObject of type%s %s\"%s\"%s", PROP_VALUE_COLOR,
-                             RESET_COLOR, DATATYPE_COLOR,
-                             g_type_name (param->value_type), RESET_COLOR);
-                } else if (G_IS_PARAM_SPEC_BOXED (param)) {
-                    n_print ("%sBoxed pointer of type%s %s\"%s\"%s", PROP_VALUE_COLOR,
-                             RESET_COLOR, DATATYPE_COLOR,
-                             g_type_name (param->value_type), RESET_COLOR);
-                    if (param->value_type == GST_TYPE_STRUCTURE) {
-                        const GstStructure *s = gst_value_get_structure (&value);
-                        if (s) {
-                            g_print ("\n");
-                            gst_structure_foreach (s, print_field,
-                                                   (gpointer) "                           ");
-                        }
-                    }
-                } else if (G_IS_PARAM_SPEC_POINTER (param)) {
-                    if (param->value_type != G_TYPE_POINTER) {
-                        n_print ("%sPointer of type%s %s\"%s\"%s.", PROP_VALUE_COLOR,
-                                 RESET_COLOR, DATATYPE_COLOR, g_type_name (param->value_type),
-                                 RESET_COLOR);
-                    } else {
-                        n_print ("%sPointer.%s", PROP_VALUE_COLOR, RESET_COLOR);
-                    }
-                } else if (param->value_type == G_TYPE_VALUE_ARRAY) {
-                    GParamSpecValueArray *pvarray = G_PARAM_SPEC_VALUE_ARRAY (param);
+    *n_specs = list->n_specs;
+    return list->specs;
+}
 
-                    if (pvarray->element_spec) {
-                        n_print ("%sArray of GValues of type%s %s\"%s\"%s",
-                                 PROP_VALUE_COLOR, RESET_COLOR, DATATYPE_COLOR,
-                                 g_type_name (pvarray->element_spec->value_type), RESET_COLOR);
-                    } else {
-                        n_print ("%sArray of GValues%s", PROP_VALUE_COLOR, RESET_COLOR);
-                    }
-                } else if (GST_IS_PARAM_SPEC_FRACTION (param)) {
-                    GstParamSpecFraction *pfraction = GST_PARAM_SPEC_FRACTION (param);
-
-                    n_print ("%sFraction%s. %sRange%s: %s%d/%d - %d/%d%s "
-                             "%sDefault%s: %s%d/%d%s ", DATATYPE_COLOR, RESET_COLOR,
-                             PROP_ATTR_NAME_COLOR, RESET_COLOR, PROP_ATTR_VALUE_COLOR,
-                             pfraction->min_num, pfraction->min_den, pfraction->max_num,
-                             pfraction->max_den, RESET_COLOR, PROP_ATTR_NAME_COLOR,
-                             RESET_COLOR, PROP_ATTR_VALUE_COLOR,
-                             gst_value_get_fraction_numerator (&value),
-                             gst_value_get_fraction_denominator (&value), RESET_COLOR);
-                } else if (param->value_type == GST_TYPE_ARRAY) {
-                    GstParamSpecArray *parray = GST_PARAM_SPEC_ARRAY_LIST (param);
-
-                    if (parray->element_spec) {
-                        n_print ("%sGstValueArray of GValues of type%s %s\"%s\"%s",
-                                 PROP_VALUE_COLOR, RESET_COLOR, DATATYPE_COLOR,
-                                 g_type_name (parray->element_spec->value_type), RESET_COLOR);
-                    } else {
-                        n_print ("%sGstValueArray of GValues%s", PROP_VALUE_COLOR,
-                                 RESET_COLOR);
-                    }
-                } else {
-                    n_print ("%sUnknown type %ld%s %s\"%s\"%s", PROP_VALUE_COLOR,
-                             (glong) param->value_type, RESET_COLOR, DATATYPE_COLOR,
-                             g_type_name (param->value_type), RESET_COLOR);
-                }
-                break;
+static void
+print_property_info_cached (GObjectClass * obj_class, GParamSpec * param,
+                            const GValue * value, gboolean readable)
+{
+    InspectOutput capture = { NULL, G_MAXSIZE, NULL, NULL };
+    InspectOutput *saved_output = output;
+    gchar *value_str = property_value_key (param, value);
+    gchar *key, *text = NULL;
+    PropertyText *cached;
+
+    if (value_str == NULL) {
+        print_property_info (obj_class, param, value, readable);
+        return;
+    }
+
+    key = g_strdup_printf ("%p:%d:%d", param, indent, colored_output);
+
+    g_mutex_lock (&property_lock);
+    if (property_texts == NULL)
+        property_texts = g_hash_table_new_full (g_str_hash, g_str_equal, g_free,
+                                                (GDestroyNotify) property_text_free);
+    cached = g_hash_table_lookup (property_texts, key);
+    if (cached != NULL && !strcmp (cached->value_str, value_str))
+        text = g_strdup (cached->text);
+    g_mutex_unlock (&property_lock);
+
+    if (text == NULL) {
+        /* the text includes the indentation, which is why it is in the key */
+        capture.str = g_string_new (NULL);
+        output = &capture;
+        print_property_info (obj_class, param, value, readable);
+        output = saved_output;
+        text = g_string_free (capture.str, FALSE);
+
+        cached = g_new0 (PropertyText, 1);
+        cached->value_str = value_str;
+        cached->text = g_strdup (text);
+        value_str = NULL;
+        g_mutex_lock (&property_lock);
+        g_hash_table_replace (property_texts, key, cached);
+        g_mutex_unlock (&property_lock);
+        key = NULL;
+    }
+
+    inspect_output_write (text, strlen (text));
+    g_free (text);
+    g_free (value_str);
+    g_free (key);
+}
+
+/* obj will be NULL if we're printing properties of pad template pads */
+static void
+print_object_properties_info (GObject * obj, GObjectClass * obj_class,
+                              const gchar * desc)
+{
+    GParamSpec **property_specs;
+    guint num_properties, i;
+    gboolean readable;
+
+    property_specs = list_properties_sorted (obj_class, &num_properties);
+
+    n_print ("%s%s%s:\n", HEADING_COLOR, desc, RESET_COLOR);
+
+    push_indent ();
+
+    for (i = 0; i < num_properties; i++) {
+        GValue value = { 0, };
+        GParamSpec *param = property_specs[i];
+        GType owner_type = param->owner_type;
+
+        /* We're printing pad properties */
+        if (obj == NULL && (owner_type == G_TYPE_OBJECT
+                            || owner_type == GST_TYPE_OBJECT || owner_type == GST_TYPE_PAD))
+            continue;
+
+        g_value_init (&value, param->value_type);
+
+        readable = ! !(param->flags & G_PARAM_READABLE);
+        if (readable && obj != NULL) {
+            g_object_get_property (obj, param->name, &value);
+        } else {
+            /* if we can't read the property value, assume it's set to the default
+             * (which might not be entirely true for sub-classes, but that's an
+             * unlikely corner-case anyway) */
+            g_param_value_set_default (param, &value);
         }
-        if (!readable)
-            g_print (" %sWrite only%s\n", PROP_VALUE_COLOR, RESET_COLOR);
-        else
-            g_print ("\n");
 
-        pop_indent_n (11);
+        print_property_info_cached (obj_class, param, &value, readable);
 
         g_value_reset (&value);
     }
@@ -722,8 +1009,6 @@ print_object_properties_info (GObject * obj, GObjectClass * obj_class,
         n_print ("%snone%s\n", PROP_VALUE_COLOR, RESET_COLOR);
 
     pop_indent ();
-
-    g_free (property_specs);
 }
 
 static void
@@ -1176,20 +1461,166 @@ gst_plugin_feature_name_compare_func (gconstpointer p1, gconstpointer p2)
     return strcmp (GST_OBJECT_NAME (p1), GST_OBJECT_NAME (p2));
 }
 
-static void
-print_blacklist (void)
+/* Registry listing: the plugins and their features as flat arrays, sorted
+ * by sort_output and kept until the registry cookie changes. The features
+ * of a plugin are contiguous. Listings iterate it instead of fetching,
+ * sorting and reffing the registry's lists again for every plugin, and
+ * hold a reference while doing so. */
+typedef struct
 {
-    GList *plugins, *cur;
-    gint count = 0;
+    GstPlugin *plugin;
+    guint first_feature;          /* into RegistryListing.features */
+    guint n_features;
+} ListingPlugin;
 
-    g_print ("%s%s%s\n", HEADING_COLOR, _("Blacklisted files:"), RESET_COLOR);
+typedef struct
+{
+    gint ref_count;
+    guint32 cookie;
+    SortType sort;
+    ListingPlugin *plugins;
+    guint n_plugins;
+    GstPluginFeature **features;
+    guint n_features;
+    GHashTable *by_name;          /* plugin name -> ListingPlugin */
+} RegistryListing;
+
+static GMutex listing_lock;
+static RegistryListing *registry_listing = NULL;
 
-    plugins = gst_registry_get_plugin_list (gst_registry_get ());
-    if (sort_output == SORT_TYPE_NAME)
+static void
+registry_listing_unref (RegistryListing * listing)
+{
+    guint i;
+
+    if (!g_atomic_int_dec_and_test (&listing->ref_count))
+        return;
+
+    for (i = 0; i < listing->n_plugins; i++)
+        gst_object_unref (listing->plugins[i].plugin);
+    for (i = 0; i < listing->n_features; i++)
+        gst_object_unref (listing->features[i]);
+    g_hash_table_unref (listing->by_name);
+    g_free (listing->plugins);
+    g_free (listing->features);
+    g_free (listing);
+}
+
+static RegistryListing *
+registry_listing_build (SortType sort)
+{
+    GstRegistry *registry = gst_registry_get ();
+    RegistryListing *listing = g_new0 (RegistryListing, 1);
+    ListingPlugin **owners;
+    GList *plugins, *features, *l;
+    guint i, n, first;
+
+    listing->ref_count = 1;
+    listing->cookie = gst_registry_get_feature_list_cookie (registry);
+    listing->sort = sort;
+    listing->by_name = g_hash_table_new (g_str_hash, g_str_equal);
+
+    plugins = gst_registry_get_plugin_list (registry);
+    if (sort == SORT_TYPE_NAME)
         plugins = g_list_sort (plugins, gst_plugin_name_compare_func);
+    listing->plugins = g_new0 (ListingPlugin, g_list_length (plugins));
+    for (l = plugins; l != NULL; l = l->next) {
+        ListingPlugin *lp = &listing->plugins[listing->n_plugins++];
+
+        /* the listing takes over the list's reference */
+        lp->plugin = l->data;
+        g_hash_table_insert (listing->by_name,
+                             (gpointer) gst_plugin_get_name (lp->plugin), lp);
+    }
+    g_list_free (plugins);
+
+    /* All features at once, sorted, then grouped by plugin: each group
+     * keeps the order of the full list */
+    features = gst_registry_get_feature_list (registry, GST_TYPE_PLUGIN_FEATURE);
+    if (sort == SORT_TYPE_NAME)
+        features = g_list_sort (features, gst_plugin_feature_name_compare_func);
+    n = g_list_length (features);
+    owners = g_new0 (ListingPlugin *, n);
+    for (l = features, i = 0; l != NULL; l = l->next, i++) {
+        const gchar *plugin_name =
+                gst_plugin_feature_get_plugin_name (GST_PLUGIN_FEATURE (l->data));
+
+        if (plugin_name != NULL)
+            owners[i] = g_hash_table_lookup (listing->by_name, plugin_name);
+        if (owners[i] != NULL)
+            owners[i]->n_features++;
+    }
+
+    for (i = 0, first = 0; i < listing->n_plugins; i++) {
+        listing->plugins[i].first_feature = first;
+        first += listing->plugins[i].n_features;
+        listing->plugins[i].n_features = 0;
+    }
+
+    listing->features = g_new0 (GstPluginFeature *, first);
+    listing->n_features = first;
+    for (l = features, i = 0; l != NULL; l = l->next, i++) {
+        ListingPlugin *lp = owners[i];
+
+        if (lp == NULL) {
+            gst_object_unref (l->data);
+            continue;
+        }
+        listing->features[lp->first_feature + lp->n_features++] = l->data;
+    }
+    g_list_free (features);
+    g_free (owners);
+
+    GST_INFO ("Registry listing: %u plugins, %u features", listing->n_plugins,
+              listing->n_features);
+    return listing;
+}
+
+/* The listing matching the registry and sort_output. Release it with
+ * registry_listing_unref(). */
+static RegistryListing *
+registry_listing_get (void)
+{
+    guint32 cookie = gst_registry_get_feature_list_cookie (gst_registry_get ());
+    RegistryListing *listing;
+
+    g_mutex_lock (&listing_lock);
+    if (registry_listing == NULL || registry_listing->cookie != cookie ||
+        registry_listing->sort != sort_output) {
+        if (registry_listing != NULL)
+            registry_listing_unref (registry_listing);
+        registry_listing = registry_listing_build (sort_output);
+    }
+    listing = registry_listing;
+    g_atomic_int_inc (&listing->ref_count);
+    g_mutex_unlock (&listing_lock);
 
-    for (cur = plugins; cur != NULL; cur = g_list_next (cur)) {
-        GstPlugin *plugin = (GstPlugin *) (cur->data);
+    return listing;
+}
+
+/* The features of @plugin in @listing, NULL if it has none there */
+static GstPluginFeature **
+registry_listing_features (RegistryListing * listing, GstPlugin * plugin,
+                           guint * n_features)
+{
+    ListingPlugin *lp = g_hash_table_lookup (listing->by_name,
+                                             gst_plugin_get_name (plugin));
+
+    *n_features = lp ? lp->n_features : 0;
+    return lp ? listing->features + lp->first_feature : NULL;
+}
+
+static void
+print_blacklist (void)
+{
+    RegistryListing *listing = registry_listing_get ();
+    gint count = 0;
+    guint i;
+
+    g_print ("%s%s%s\n", HEADING_COLOR, _("Blacklisted files:"), RESET_COLOR);
+
+    for (i = 0; i < listing->n_plugins; i++) {
+        GstPlugin *plugin = listing->plugins[i].plugin;
         if (GST_OBJECT_FLAG_IS_SET (plugin, GST_PLUGIN_FLAG_BLACKLISTED)) {
             g_print ("  %s\n", gst_plugin_get_name (plugin));
             count++;
@@ -1202,7 +1633,7 @@ print_blacklist (void)
     g_print (ngettext ("%d blacklisted file", "%d blacklisted files", count),
              count);
     g_print ("%s\n", RESET_COLOR);
-    gst_plugin_list_free (plugins);
+    registry_listing_unref (listing);
 }
 
 static void
@@ -1216,12 +1647,103 @@ print_typefind_extensions (const gchar * const *extensions, const gchar * color)
     }
 }
 
+typedef struct
+{
+    GstPluginFeature *feature;
+    GString *text;              /* What print_element_info() printed */
+    gboolean done;
+} ElementJob;
+
+typedef struct
+{
+    ElementJob *jobs;
+    gboolean index_bypass;      /* The caller's inspect_index_bypass */
+    GMutex lock;
+    GCond cond;
+} ElementJobQueue;
+
+static void
+element_job_run (ElementJob * job, ElementJobQueue * queue)
+{
+    InspectOutput out = { NULL, G_MAXSIZE, NULL, NULL };
+
+    out.str = g_string_new (NULL);
+    if (!inspect_cancelled ()) {
+        output = &out;
+        inspect_index_bypass = queue->index_bypass;
+        print_element_info (job->feature, TRUE);
+        inspect_index_bypass = FALSE;
+        output = NULL;
+    }
+
+    g_mutex_lock (&queue->lock);
+    job->text = out.str;
+    job->done = TRUE;
+    g_cond_broadcast (&queue->cond);
+    g_mutex_unlock (&queue->lock);
+}
+
+/* Introspect @features on @n_threads threads, each into a buffer of its own,
+ * and print the buffers in the original order as they complete, so the
+ * output is the same as printing them one after the other. Jobs are only
+ * handed out a small window ahead of the one being printed, which keeps the
+ * buffered output bounded. */
+static void
+print_element_info_parallel (GPtrArray * features, guint n_threads)
+{
+    ElementJobQueue queue;
+    GThreadPool *pool;
+    guint i, queued, window = 4 * n_threads;
+    gint64 start = g_get_monotonic_time ();
+
+    queue.jobs = g_new0 (ElementJob, features->len);
+    queue.index_bypass = inspect_index_bypass;
+    g_mutex_init (&queue.lock);
+    g_cond_init (&queue.cond);
+
+    pool = g_thread_pool_new ((GFunc) element_job_run, &queue, n_threads, FALSE,
+                              NULL);
+    for (queued = 0; queued < MIN (window, features->len); queued++) {
+        queue.jobs[queued].feature = g_ptr_array_index (features, queued);
+        g_thread_pool_push (pool, &queue.jobs[queued], NULL);
+    }
+
+    for (i = 0; i < features->len; i++) {
+        ElementJob *job = &queue.jobs[i];
+
+        g_mutex_lock (&queue.lock);
+        while (!job->done)
+            g_cond_wait (&queue.cond, &queue.lock);
+        g_mutex_unlock (&queue.lock);
+
+        inspect_output_write (job->text->str, job->text->len);
+        g_string_free (job->text, TRUE);
+
+        if (queued < features->len) {
+            queue.jobs[queued].feature = g_ptr_array_index (features, queued);
+            g_thread_pool_push (pool, &queue.jobs[queued], NULL);
+            queued++;
+        }
+    }
+
+    g_thread_pool_free (pool, FALSE, TRUE);
+    g_mutex_clear (&queue.lock);
+    g_cond_clear (&queue.cond);
+    g_free (queue.jobs);
+
+    GST_INFO ("Introspected %u elements on %u threads in %.2f seconds",
+              features->len, n_threads,
+              (g_get_monotonic_time () - start) / (gdouble) G_USEC_PER_SEC);
+}
+
 static void
 print_element_list (gboolean print_all, gchar * ftypes)
 {
     int plugincount = 0, featurecount = 0, blacklistcount = 0;
-    GList *plugins, *orig_plugins;
+    RegistryListing *listing;
     gchar **types = NULL;
+    GPtrArray *jobs = NULL;
+    guint n_threads, p, f;
 
     if (ftypes) {
         gint i;
@@ -1232,15 +1754,20 @@ print_element_list (gboolean print_all, gchar * ftypes)
 
     }
 
-    orig_plugins = plugins = gst_registry_get_plugin_list (gst_registry_get ());
-    if (sort_output == SORT_TYPE_NAME)
-        plugins = g_list_sort (plugins, gst_plugin_name_compare_func);
-    while (plugins) {
-        GList *features, *orig_features;
-        GstPlugin *plugin;
+    /* with -a only element details are printed, so they can all be collected
+     * first and introspected in parallel */
+    n_threads = inspect_jobs > 0 ? inspect_jobs : g_get_num_processors ();
+    if (print_all && n_threads > 1)
+        jobs = g_ptr_array_new_with_free_func (gst_object_unref);
+
+    listing = registry_listing_get ();
+    for (p = 0; p < listing->n_plugins; p++) {
+        ListingPlugin *lp = &listing->plugins[p];
+        GstPlugin *plugin = lp->plugin;
+
+        if (inspect_cancelled ())
+            break;
 
-        plugin = (GstPlugin *) (plugins->data);
-        plugins = g_list_next (plugins);
         plugincount++;
 
         if (GST_OBJECT_FLAG_IS_SET (plugin, GST_PLUGIN_FLAG_BLACKLISTED)) {
@@ -1248,17 +1775,11 @@ print_element_list (gboolean print_all, gchar * ftypes)
             continue;
         }
 
-        orig_features = features =
-                gst_registry_get_feature_list_by_plugin (gst_registry_get (),
-                                                         gst_plugin_get_name (plugin));
-        if (sort_output == SORT_TYPE_NAME)
-            features = g_list_sort (features, gst_plugin_feature_name_compare_func);
-        while (features) {
-            GstPluginFeature *feature;
+        for (f = 0; f < lp->n_features; f++) {
+            GstPluginFeature *feature = listing->features[lp->first_feature + f];
 
-            if (G_UNLIKELY (features->data == NULL))
-                goto next;
-            feature = GST_PLUGIN_FEATURE (features->data);
+            if (inspect_cancelled ())
+                break;
             featurecount++;
 
             if (GST_IS_ELEMENT_FACTORY (feature)) {
@@ -1281,9 +1802,11 @@ print_element_list (gboolean print_all, gchar * ftypes)
                     }
 
                     if (!all_found)
-                        goto next;
+                        continue;
                 }
-                if (print_all)
+                if (jobs)
+                    g_ptr_array_add (jobs, gst_object_ref (feature));
+                else if (print_all)
                     print_element_info (feature, TRUE);
                 else
                     g_print ("%s%s%s:  %s%s%s: %s%s%s\n", PLUGIN_NAME_COLOR,
@@ -1296,7 +1819,7 @@ print_element_list (gboolean print_all, gchar * ftypes)
                 const gchar *const *extensions;
 
                 if (types)
-                    goto next;
+                    continue;
                 factory = GST_TYPE_FIND_FACTORY (feature);
                 if (!print_all)
                     g_print ("%s%s%s: %s%s%s: ", PLUGIN_NAME_COLOR,
@@ -1315,24 +1838,32 @@ print_element_list (gboolean print_all, gchar * ftypes)
                 }
             } else {
                 if (types)
-                    goto next;
+                    continue;
                 if (!print_all)
                     n_print ("%s%s%s:  %s%s%s (%s%s%s)\n", PLUGIN_NAME_COLOR,
                              gst_plugin_get_name (plugin), RESET_COLOR, ELEMENT_NAME_COLOR,
                              GST_OBJECT_NAME (feature), RESET_COLOR, ELEMENT_DETAIL_COLOR,
                              g_type_name (G_OBJECT_TYPE (feature)), RESET_COLOR);
             }
-
-            next:
-            features = g_list_next (features);
         }
-
-        gst_plugin_feature_list_free (orig_features);
     }
 
-    gst_plugin_list_free (orig_plugins);
+    registry_listing_unref (listing);
     g_strfreev (types);
 
+    if (jobs) {
+        if (jobs->len > 0)
+            print_element_info_parallel (jobs, MIN (n_threads, jobs->len));
+        g_ptr_array_unref (jobs);
+    }
+
+    if (inspect_json && print_all) {
+        /* every line has "element" and "section", this one is about none */
+        g_print ("{\"element\":null,\"section\":\"total\",\"plugins\":%d,\"blacklisted\":%d,"
+                 "\"features\":%d}\n", plugincount, blacklistcount, featurecount);
+        return;
+    }
+
     g_print ("\n");
     g_print (_("%sTotal count%s: %s"), PROP_NAME_COLOR, RESET_COLOR,
              PROP_VALUE_COLOR);
@@ -1348,88 +1879,249 @@ print_element_list (gboolean print_all, gchar * ftypes)
     g_print ("%s\n", RESET_COLOR);
 }
 
+/* URI handler index: protocol -> handling factories, from the protocols
+ * the registry records for each factory, so neither building it nor
+ * looking a protocol up loads any plugin. */
+typedef struct
+{
+    GstElementFactory *factory;
+    const gchar *plugin;        /* Plugin name */
+    GstURIType type;
+    guint rank;
+} UriHandler;
+
+typedef struct
+{
+    guint32 cookie;             /* Feature list cookie the index was built for */
+    GPtrArray *handlers;        /* UriHandler in registry order, owns them */
+    GPtrArray *by_name;         /* The same sorted by plugin and feature name */
+    GHashTable *by_protocol;    /* Lowercase protocol -> GPtrArray of UriHandler */
+} UriIndex;
+
+static GMutex uri_lock;
+static UriIndex *uri_index = NULL;
+
 static void
-print_all_uri_handlers (void)
+uri_handler_free (UriHandler * handler)
 {
-    GList *plugins, *p, *features, *f;
+    gst_object_unref (handler->factory);
+    g_free (handler);
+}
 
-    plugins = gst_registry_get_plugin_list (gst_registry_get ());
-    if (sort_output == SORT_TYPE_NAME)
-        plugins = g_list_sort (plugins, gst_plugin_name_compare_func);
-    for (p = plugins; p; p = p->next) {
-        GstPlugin *plugin = (GstPlugin *) (p->data);
+static void
+uri_index_free (UriIndex * index)
+{
+    g_hash_table_unref (index->by_protocol);
+    g_ptr_array_unref (index->by_name);
+    g_ptr_array_unref (index->handlers);
+    g_free (index);
+}
 
-        features =
-                gst_registry_get_feature_list_by_plugin (gst_registry_get (),
-                                                         gst_plugin_get_name (plugin));
-        if (sort_output == SORT_TYPE_NAME)
-            features = g_list_sort (features, gst_plugin_feature_name_compare_func);
-        for (f = features; f; f = f->next) {
-            GstPluginFeature *feature = GST_PLUGIN_FEATURE (f->data);
+/* Highest rank first, then by name */
+static gint
+uri_handler_compare_rank (gconstpointer a, gconstpointer b)
+{
+    const UriHandler *ha = *(const UriHandler **) a;
+    const UriHandler *hb = *(const UriHandler **) b;
 
-            if (GST_IS_ELEMENT_FACTORY (feature)) {
-                GstElementFactory *factory;
-                GstElement *element;
+    if (ha->rank != hb->rank)
+        return ha->rank > hb->rank ? -1 : 1;
+    return strcmp (GST_OBJECT_NAME (ha->factory), GST_OBJECT_NAME (hb->factory));
+}
 
-                factory = GST_ELEMENT_FACTORY (gst_plugin_feature_load (feature));
-                if (!factory) {
-                    g_print ("element plugin %s couldn't be loaded\n",
-                             gst_plugin_get_name (plugin));
-                    continue;
-                }
+/* Plugin name, then feature name, like the other listings */
+static gint
+uri_handler_compare_name (gconstpointer a, gconstpointer b)
+{
+    const UriHandler *ha = *(const UriHandler **) a;
+    const UriHandler *hb = *(const UriHandler **) b;
+    gint ret = strcmp (ha->plugin, hb->plugin);
 
-                element = gst_element_factory_create (factory, NULL);
-                if (!element) {
-                    g_print ("couldn't construct element for %s for some reason\n",
-                             GST_OBJECT_NAME (factory));
-                    gst_object_unref (factory);
-                    continue;
-                }
+    return ret ? ret : strcmp (GST_OBJECT_NAME (ha->factory),
+                               GST_OBJECT_NAME (hb->factory));
+}
 
-                if (GST_IS_URI_HANDLER (element)) {
-                    const gchar *const *uri_protocols;
-                    const gchar *const *protocol;
-                    const gchar *dir;
+static UriIndex *
+uri_index_build (void)
+{
+    GstRegistry *registry = gst_registry_get ();
+    UriIndex *index = g_new0 (UriIndex, 1);
+    GHashTableIter iter;
+    gpointer list;
+    GList *features, *f;
+    guint i;
 
-                    switch (gst_uri_handler_get_uri_type (GST_URI_HANDLER (element))) {
-                        case GST_URI_SRC:
-                            dir = "read";
-                            break;
-                        case GST_URI_SINK:
-                            dir = "write";
-                            break;
-                        default:
-                            dir = "unknown";
-                            break;
-                    }
+    index->cookie = gst_registry_get_feature_list_cookie (registry);
+    index->handlers =
+            g_ptr_array_new_with_free_func ((GDestroyNotify) uri_handler_free);
+    index->by_protocol = g_hash_table_new_full (g_str_hash, g_str_equal, g_free,
+                                                (GDestroyNotify) g_ptr_array_unref);
 
-                    g_print ("%s%s%s (%s%s%s, %srank %u%s): ",
-                             FEATURE_NAME_COLOR,
-                             gst_plugin_feature_get_name (GST_PLUGIN_FEATURE (factory)),
-                             RESET_COLOR, FEATURE_DIR_COLOR, dir, RESET_COLOR,
-                             FEATURE_RANK_COLOR,
-                             gst_plugin_feature_get_rank (GST_PLUGIN_FEATURE (factory)),
-                             RESET_COLOR);
+    features = gst_registry_get_feature_list (registry, GST_TYPE_ELEMENT_FACTORY);
+    for (f = features; f != NULL; f = f->next) {
+        GstElementFactory *factory = GST_ELEMENT_FACTORY (f->data);
+        const gchar *const *protocols = gst_element_factory_get_uri_protocols (factory);
+        GstURIType type = gst_element_factory_get_uri_type (factory);
+        UriHandler *handler;
 
-                    uri_protocols =
-                            gst_uri_handler_get_protocols (GST_URI_HANDLER (element));
-                    for (protocol = uri_protocols; *protocol != NULL; protocol++) {
-                        if (protocol != uri_protocols)
-                            g_print (", ");
-                        g_print ("%s%s%s", FEATURE_PROTO_COLOR, *protocol, RESET_COLOR);
-                    }
-                    g_print ("\n");
-                }
+        if (type == GST_URI_UNKNOWN || protocols == NULL || *protocols == NULL)
+            continue;
 
-                gst_object_unref (element);
-                gst_object_unref (factory);
+        handler = g_new0 (UriHandler, 1);
+        handler->factory = gst_object_ref (factory);
+        handler->plugin = gst_plugin_feature_get_plugin_name (GST_PLUGIN_FEATURE (factory));
+        handler->plugin = GST_STR_NULL (handler->plugin);
+        handler->type = type;
+        handler->rank = gst_plugin_feature_get_rank (GST_PLUGIN_FEATURE (factory));
+        g_ptr_array_add (index->handlers, handler);
+
+        for (; *protocols != NULL; protocols++) {
+            gchar *protocol = g_ascii_strdown (*protocols, -1);
+            GPtrArray *handlers = g_hash_table_lookup (index->by_protocol, protocol);
+
+            if (handlers == NULL) {
+                handlers = g_ptr_array_new ();
+                g_hash_table_insert (index->by_protocol, protocol, handlers);
+            } else {
+                g_free (protocol);
             }
+            g_ptr_array_add (handlers, handler);
         }
+    }
+    gst_plugin_feature_list_free (features);
 
-        gst_plugin_feature_list_free (features);
+    index->by_name = g_ptr_array_sized_new (index->handlers->len);
+    for (i = 0; i < index->handlers->len; i++)
+        g_ptr_array_add (index->by_name, g_ptr_array_index (index->handlers, i));
+    g_ptr_array_sort (index->by_name, uri_handler_compare_name);
+
+    g_hash_table_iter_init (&iter, index->by_protocol);
+    while (g_hash_table_iter_next (&iter, NULL, &list))
+        g_ptr_array_sort (list, uri_handler_compare_rank);
+
+    GST_INFO ("URI index: %u handlers, %u protocols", index->handlers->len,
+              g_hash_table_size (index->by_protocol));
+    return index;
+}
+
+/* Make sure uri_index matches the registry. Call with uri_lock held. */
+static void
+uri_index_update (void)
+{
+    guint32 cookie = gst_registry_get_feature_list_cookie (gst_registry_get ());
+
+    if (uri_index != NULL && uri_index->cookie == cookie)
+        return;
+    if (uri_index != NULL)
+        uri_index_free (uri_index);
+    uri_index = uri_index_build ();
+}
+
+/* The best ranked factory handling @protocol in direction @type, or NULL.
+ * Returns a new reference. */
+static GstElementFactory *
+uri_index_lookup (const gchar * protocol, GstURIType type)
+{
+    GstElementFactory *factory = NULL;
+    gchar *key = g_ascii_strdown (protocol, -1);
+    GPtrArray *handlers;
+    guint i;
+
+    g_mutex_lock (&uri_lock);
+    uri_index_update ();
+    handlers = g_hash_table_lookup (uri_index->by_protocol, key);
+    for (i = 0; handlers != NULL && i < handlers->len; i++) {
+        UriHandler *handler = g_ptr_array_index (handlers, i);
+
+        if (handler->type == type) {
+            factory = gst_object_ref (handler->factory);
+            break;
+        }
     }
+    g_mutex_unlock (&uri_lock);
 
-    gst_plugin_list_free (plugins);
+    g_free (key);
+    return factory;
+}
+
+static void
+print_uri_handler (const UriHandler * handler)
+{
+    const gchar *const *uri_protocols;
+    const gchar *const *protocol;
+    const gchar *dir;
+
+    switch (handler->type) {
+        case GST_URI_SRC:
+            dir = "read";
+            break;
+        case GST_URI_SINK:
+            dir = "write";
+            break;
+        default:
+            dir = "unknown";
+            break;
+    }
+
+    g_print ("%s%s%s (%s%s%s, %srank %u%s): ",
+             FEATURE_NAME_COLOR,
+             gst_plugin_feature_get_name (GST_PLUGIN_FEATURE (handler->factory)),
+             RESET_COLOR, FEATURE_DIR_COLOR, dir, RESET_COLOR,
+             FEATURE_RANK_COLOR, handler->rank, RESET_COLOR);
+
+    uri_protocols = gst_element_factory_get_uri_protocols (handler->factory);
+    for (protocol = uri_protocols; *protocol != NULL; protocol++) {
+        if (protocol != uri_protocols)
+            g_print (", ");
+        g_print ("%s%s%s", FEATURE_PROTO_COLOR, *protocol, RESET_COLOR);
+    }
+    g_print ("\n");
+}
+
+static void
+print_all_uri_handlers (void)
+{
+    GPtrArray *handlers;
+    guint i;
+
+    g_mutex_lock (&uri_lock);
+    uri_index_update ();
+
+    handlers = sort_output == SORT_TYPE_NAME ? uri_index->by_name :
+            uri_index->handlers;
+    for (i = 0; i < handlers->len && !inspect_cancelled (); i++)
+        print_uri_handler (g_ptr_array_index (handlers, i));
+    g_mutex_unlock (&uri_lock);
+}
+
+/* --uri: the elements that can read or write @uri, best ranked first */
+static int
+print_uri_handlers_for (const gchar * uri)
+{
+    gchar *protocol = gst_uri_get_protocol (uri);
+    GPtrArray *handlers;
+    guint i;
+
+    /* a bare protocol name works too */
+    if (protocol == NULL)
+        protocol = g_ascii_strdown (uri, -1);
+    if (!gst_uri_protocol_is_valid (protocol)) {
+        g_printerr ("'%s' is not a URI or protocol\n", uri);
+        g_free (protocol);
+        return -1;
+    }
+
+    g_mutex_lock (&uri_lock);
+    uri_index_update ();
+    handlers = g_hash_table_lookup (uri_index->by_protocol, protocol);
+    for (i = 0; handlers != NULL && i < handlers->len; i++)
+        print_uri_handler (g_ptr_array_index (handlers, i));
+    g_mutex_unlock (&uri_lock);
+
+    if (handlers == NULL)
+        g_print ("No element handles '%s' URIs\n", protocol);
+    g_free (protocol);
+    return handlers == NULL ? 1 : 0;
 }
 
 static void
@@ -1488,7 +2180,9 @@ print_plugin_info (GstPlugin * plugin)
 static void
 print_plugin_features (GstPlugin * plugin)
 {
-    GList *features, *origlist;
+    RegistryListing *listing = registry_listing_get ();
+    GstPluginFeature **features;
+    guint n_features, i;
     gint num_features = 0;
     gint num_elements = 0;
     gint num_tracers = 0;
@@ -1496,15 +2190,9 @@ print_plugin_features (GstPlugin * plugin)
     gint num_devproviders = 0;
     gint num_other = 0;
 
-    origlist = features =
-            gst_registry_get_feature_list_by_plugin (gst_registry_get (),
-                                                     gst_plugin_get_name (plugin));
-    if (sort_output == SORT_TYPE_NAME)
-        features = g_list_sort (features, gst_plugin_feature_name_compare_func);
-    while (features) {
-        GstPluginFeature *feature;
-
-        feature = GST_PLUGIN_FEATURE (features->data);
+    features = registry_listing_features (listing, plugin, &n_features);
+    for (i = 0; i < n_features; i++) {
+        GstPluginFeature *feature = features[i];
 
         if (GST_IS_ELEMENT_FACTORY (feature)) {
             GstElementFactory *factory;
@@ -1553,10 +2241,9 @@ print_plugin_features (GstPlugin * plugin)
             num_other++;
         }
         num_features++;
-        features = g_list_next (features);
     }
 
-    gst_plugin_feature_list_free (origlist);
+    registry_listing_unref (listing);
 
     n_print ("\n");
     n_print ("  %s%d features%s:\n", HEADING_COLOR, num_features, RESET_COLOR);
@@ -1602,7 +2289,11 @@ print_feature_info (const gchar * feature_name, gboolean print_all)
         goto handled;
     }
 
-    /* TODO: handle DEVICE_PROVIDER_FACTORY */
+    if ((feature = gst_registry_find_feature (registry, feature_name,
+                                              GST_TYPE_DEVICE_PROVIDER_FACTORY))) {
+        ret = print_device_provider_info (feature, print_all);
+        goto handled;
+    }
 
     return -1;
 
@@ -1611,395 +2302,3399 @@ print_feature_info (const gchar * feature_name, gboolean print_all)
     return ret;
 }
 
-static int
-print_element_info (GstPluginFeature * feature, gboolean print_names)
+/* Inspect index: print_element_info() output kept on disk so that elements
+ * of unchanged plugins don't have to be loaded and instantiated again.
+ *
+ * Layout: InspectIndexHeader, n_entries InspectIndexEntry sorted by feature
+ * name then flags, and a blob of NUL terminated strings the entries point
+ * into. All offsets are from the start of the file, which is mapped as is.
+ * An entry is only used while the plugin file it was built from still has
+ * the same name, mtime and size, like the registry cache does. */
+#define INSPECT_INDEX_MAGIC   0x49545347  /* "GSTI" */
+#define INSPECT_INDEX_VERSION 1
+
+#define INDEX_FLAG_NAMES  (1 << 0)      /* print_names was set */
+#define INDEX_FLAG_COLORS (1 << 1)      /* colored_output was set */
+#define INDEX_FLAG_JSON   (1 << 2)      /* --json, names and colors don't apply */
+
+typedef struct
 {
-    GstElementFactory *factory;
-    GstElement *element;
-    GstPlugin *plugin;
-    gint maxlevel = 0;
+    guint32 magic;
+    guint32 version;
+    guint32 n_entries;
+    guint32 reserved;
+} InspectIndexHeader;
 
-    factory = GST_ELEMENT_FACTORY (gst_plugin_feature_load (feature));
-    if (!factory) {
-        g_print ("%selement plugin couldn't be loaded%s\n", DESC_COLOR,
-                 RESET_COLOR);
-        return -1;
-    }
+typedef struct
+{
+    guint32 name_offset;
+    guint32 filename_offset;
+    guint32 text_offset;
+    guint32 text_len;
+    guint32 flags;
+    guint32 reserved;
+    gint64 mtime;
+    guint64 size;
+} InspectIndexEntry;
+
+/* An entry introspected during this run and not written out yet */
+typedef struct
+{
+    gchar *name;
+    gchar *filename;
+    gchar *text;
+    gsize text_len;
+    guint32 flags;
+    gint64 mtime;
+    guint64 size;
+} InspectIndexPending;
+
+static GMutex index_lock;
+static gboolean index_loaded = FALSE;
+static GMappedFile *index_file = NULL;
+static const InspectIndexEntry *index_entries = NULL;
+static guint index_n_entries = 0;
+static GHashTable *index_pending = NULL;        /* "flags:name" -> pending */
 
-    element = gst_element_factory_create (factory, NULL);
-    if (!element) {
-        gst_object_unref (factory);
-        g_print ("%scouldn't construct element for some reason%s\n", DESC_COLOR,
-                 RESET_COLOR);
-        return -1;
-    }
+static gchar *
+inspect_index_path (void)
+{
+    return g_build_filename (g_get_user_cache_dir (), "gst-inspect-index.bin",
+                             NULL);
+}
 
-    if (print_names)
-        _name =
-                g_strdup_printf ("%s%s%s: ", DATATYPE_COLOR, GST_OBJECT_NAME (factory),
-                                 RESET_COLOR);
-    else
-        _name = NULL;
+static void
+inspect_index_pending_free (InspectIndexPending * pending)
+{
+    g_free (pending->name);
+    g_free (pending->filename);
+    g_free (pending->text);
+    g_free (pending);
+}
 
-    print_factory_details_info (factory);
+/* Must be called with index_lock held */
+static void
+inspect_index_load (void)
+{
+    gchar *path;
+    const InspectIndexHeader *header;
+    gsize length;
+
+    index_loaded = TRUE;
+    index_pending = g_hash_table_new_full (g_str_hash, g_str_equal, g_free,
+                                           (GDestroyNotify) inspect_index_pending_free);
+
+    path = inspect_index_path ();
+    index_file = g_mapped_file_new (path, FALSE, NULL);
+    g_free (path);
+    if (index_file == NULL)
+        return;
 
-    plugin = gst_plugin_feature_get_plugin (GST_PLUGIN_FEATURE (factory));
-    if (plugin) {
-        print_plugin_info (plugin);
-        gst_object_unref (plugin);
+    length = g_mapped_file_get_length (index_file);
+    header = (const InspectIndexHeader *) g_mapped_file_get_contents (index_file);
+    if (length < sizeof (InspectIndexHeader)
+        || header->magic != INSPECT_INDEX_MAGIC
+        || header->version != INSPECT_INDEX_VERSION
+        || (length - sizeof (InspectIndexHeader)) / sizeof (InspectIndexEntry) <
+           header->n_entries) {
+        GST_WARNING ("Ignoring invalid inspect index");
+        g_mapped_file_unref (index_file);
+        index_file = NULL;
+        return;
     }
 
-    print_hierarchy (G_OBJECT_TYPE (element), 0, &maxlevel);
-    print_interfaces (G_OBJECT_TYPE (element));
+    index_entries = (const InspectIndexEntry *) (header + 1);
+    index_n_entries = header->n_entries;
+    GST_DEBUG ("Mapped inspect index with %u entries", index_n_entries);
+}
 
-    print_pad_templates_info (element, factory);
-    print_clocking_info (element);
-    print_uri_handler_info (element);
-    print_pad_info (element);
-    print_element_properties_info (element);
-    print_signal_info (element);
-    print_children_info (element);
-    print_preset_list (element);
+static const gchar *
+inspect_index_string (guint32 offset)
+{
+    gsize length = g_mapped_file_get_length (index_file);
+    const gchar *base = g_mapped_file_get_contents (index_file);
 
-    gst_object_unref (element);
-    gst_object_unref (factory);
-    g_free (_name);
-    return 0;
+    if (offset >= length || memchr (base + offset, '\0', length - offset) == NULL)
+        return NULL;
+    return base + offset;
 }
 
-static int
-print_typefind_info (GstPluginFeature * feature, gboolean print_names)
+/* Must be called with index_lock held */
+static const InspectIndexEntry *
+inspect_index_find (const gchar * name, guint32 flags)
 {
-    GstTypeFindFactory *factory;
-    GstPlugin *plugin;
-    GstCaps *caps;
-    GstRank rank;
-    char s[40];
-    const gchar *const *extensions;
+    guint lo = 0, hi = index_n_entries;
+
+    while (lo < hi) {
+        guint mid = lo + (hi - lo) / 2;
+        const InspectIndexEntry *entry = &index_entries[mid];
+        const gchar *entry_name = inspect_index_string (entry->name_offset);
+        gint cmp;
+
+        if (entry_name == NULL)
+            return NULL;
+        cmp = strcmp (name, entry_name);
+        if (cmp == 0)
+            cmp = (gint) flags - (gint) entry->flags;
+        if (cmp == 0)
+            return entry;
+        if (cmp < 0)
+            hi = mid;
+        else
+            lo = mid + 1;
+    }
+    return NULL;
+}
 
-    factory = GST_TYPE_FIND_FACTORY (gst_plugin_feature_load (feature));
-    if (!factory) {
-        g_print ("%stypefind plugin couldn't be loaded%s\n", DESC_COLOR,
-                 RESET_COLOR);
-        return -1;
+/* Identify the file a plugin's code comes from. Plugins are usually linked
+ * statically into libgstreamer_android.so and then have no filename of
+ * their own, the library they live in stands in for them. */
+static gboolean
+plugin_file_identity (GstPlugin * plugin, const gchar ** filename,
+                      gint64 * mtime, guint64 * size)
+{
+    static gsize static_checked = 0;
+    static gchar *static_filename = NULL;
+    static gint64 static_mtime = 0;
+    static guint64 static_size = 0;
+
+    if (plugin->filename != NULL) {
+        *filename = plugin->filename;
+        *mtime = plugin->file_mtime;
+        *size = plugin->file_size;
+        return TRUE;
     }
 
-    if (print_names)
-        _name =
-                g_strdup_printf ("%s%s%s: ", DATATYPE_COLOR, GST_OBJECT_NAME (factory),
-                                 RESET_COLOR);
-    else
-        _name = NULL;
+    if (g_once_init_enter (&static_checked)) {
+#ifdef G_OS_UNIX
+        Dl_info info;
+        GStatBuf st;
+
+        if (dladdr ((void *) gst_init, &info) && info.dli_fname != NULL
+            && g_stat (info.dli_fname, &st) == 0) {
+            static_filename = g_strdup (info.dli_fname);
+            static_mtime = st.st_mtime;
+            static_size = st.st_size;
+        }
+#endif
+        g_once_init_leave (&static_checked, 1);
+    }
 
-    n_print ("%sFactory Details%s:\n", HEADING_COLOR, RESET_COLOR);
-    rank = gst_plugin_feature_get_rank (feature);
-    n_print ("  %s%-25s%s%s (%d)%s\n", PROP_NAME_COLOR, "Rank", PROP_VALUE_COLOR,
-             get_rank_name (s, rank), rank, RESET_COLOR);
-    n_print ("  %s%-25s%s%s%s\n", PROP_NAME_COLOR, "Name", PROP_VALUE_COLOR,
-             GST_OBJECT_NAME (factory), RESET_COLOR);
-    caps = gst_type_find_factory_get_caps (factory);
-    if (caps) {
-        gchar *caps_str = gst_caps_to_string (factory->caps);
+    if (static_filename == NULL)
+        return FALSE;
 
-        n_print ("  %s%-25s%s%s%s\n", PROP_NAME_COLOR, "Caps", PROP_VALUE_COLOR,
-                 caps_str, RESET_COLOR);
-        g_free (caps_str);
-    }
-    extensions = gst_type_find_factory_get_extensions (factory);
-    if (extensions) {
-        n_print ("  %s%-25s%s", PROP_NAME_COLOR, "Extensions", RESET_COLOR);
-        print_typefind_extensions (extensions, PROP_VALUE_COLOR);
-        n_print ("\n");
-    }
-    n_print ("\n");
+    *filename = static_filename;
+    *mtime = static_mtime;
+    *size = static_size;
+    return TRUE;
+}
 
-    plugin = gst_plugin_feature_get_plugin (GST_PLUGIN_FEATURE (factory));
-    if (plugin) {
-        print_plugin_info (plugin);
-        gst_object_unref (plugin);
-    }
+/* The section mask goes in the upper bits, with all sections as 0 so that
+ * entries from before --sections existed still match */
+static guint32
+inspect_index_flags (gboolean print_names)
+{
+    if (inspect_json)
+        return INDEX_FLAG_JSON |
+               (inspect_sections == INSPECT_SECTION_ALL ? 0 : inspect_sections << 8);
 
-    gst_object_unref (factory);
-    g_free (_name);
-    return 0;
+    return (print_names ? INDEX_FLAG_NAMES : 0) |
+           (colored_output ? INDEX_FLAG_COLORS : 0) |
+           (inspect_sections == INSPECT_SECTION_ALL ? 0 : inspect_sections << 8);
 }
 
-static int
-print_tracer_info (GstPluginFeature * feature, gboolean print_names)
+/* Print the indexed output for @feature if there is an up to date one */
+static gboolean
+inspect_index_print (GstPluginFeature * feature, gboolean print_names)
 {
-    GstTracerFactory *factory;
-    GstTracer *tracer;
+    const gchar *name = GST_OBJECT_NAME (feature);
+    guint32 flags = inspect_index_flags (print_names);
     GstPlugin *plugin;
-    gint maxlevel = 0;
+    const gchar *filename;
+    gint64 mtime;
+    guint64 size;
+    gboolean found = FALSE;
 
-    factory = GST_TRACER_FACTORY (gst_plugin_feature_load (feature));
-    if (!factory) {
-        g_print ("%stracer plugin couldn't be loaded%s\n", DESC_COLOR, RESET_COLOR);
-        return -1;
+    plugin = gst_plugin_feature_get_plugin (feature);
+    if (plugin == NULL)
+        return FALSE;
+    if (!plugin_file_identity (plugin, &filename, &mtime, &size)) {
+        gst_object_unref (plugin);
+        return FALSE;
     }
 
-    tracer = (GstTracer *) g_object_new (factory->type, NULL);
-    if (!tracer) {
-        gst_object_unref (factory);
-        g_print ("%scouldn't construct tracer for some reason%s\n", DESC_COLOR,
-                 RESET_COLOR);
-        return -1;
+    g_mutex_lock (&index_lock);
+    if (!index_loaded)
+        inspect_index_load ();
+
+    if (index_file != NULL) {
+        const InspectIndexEntry *entry = inspect_index_find (name, flags);
+
+        if (entry != NULL && entry->mtime == mtime && entry->size == size
+            && entry->text_offset <= g_mapped_file_get_length (index_file)
+            && entry->text_len <=
+               g_mapped_file_get_length (index_file) - entry->text_offset
+            && !g_strcmp0 (inspect_index_string (entry->filename_offset),
+                           filename)) {
+            inspect_output_write (g_mapped_file_get_contents (index_file) +
+                                  entry->text_offset, entry->text_len);
+            found = TRUE;
+        }
     }
+    g_mutex_unlock (&index_lock);
 
-    if (print_names)
-        _name =
-                g_strdup_printf ("%s%s%s: ", DATATYPE_COLOR, GST_OBJECT_NAME (factory),
-                                 RESET_COLOR);
-    else
-        _name = NULL;
+    gst_object_unref (plugin);
+    return found;
+}
 
-    n_print ("%sFactory Details%s:\n", HEADING_COLOR, RESET_COLOR);
-    n_print ("  %s%-25s%s%s%s\n", PROP_NAME_COLOR, "Name", PROP_VALUE_COLOR,
-             GST_OBJECT_NAME (factory), RESET_COLOR);
-    n_print ("\n");
+/* Remember the output just produced for @feature, written out by
+ * inspect_index_save() */
+static void
+inspect_index_add (GstPluginFeature * feature, gboolean print_names,
+                   const gchar * text, gsize text_len)
+{
+    InspectIndexPending *pending;
+    GstPlugin *plugin;
+    const gchar *filename;
+    gint64 mtime;
+    guint64 size;
 
-    plugin = gst_plugin_feature_get_plugin (GST_PLUGIN_FEATURE (factory));
-    if (plugin) {
-        print_plugin_info (plugin);
+    plugin = gst_plugin_feature_get_plugin (feature);
+    if (plugin == NULL)
+        return;
+    if (!plugin_file_identity (plugin, &filename, &mtime, &size)) {
         gst_object_unref (plugin);
+        return;
     }
 
-    print_hierarchy (G_OBJECT_TYPE (tracer), 0, &maxlevel);
-    print_interfaces (G_OBJECT_TYPE (tracer));
+    pending = g_new0 (InspectIndexPending, 1);
+    pending->name = g_strdup (GST_OBJECT_NAME (feature));
+    pending->filename = g_strdup (filename);
+    pending->text = g_strndup (text, text_len);
+    pending->text_len = text_len;
+    pending->flags = inspect_index_flags (print_names);
+    pending->mtime = mtime;
+    pending->size = size;
+    gst_object_unref (plugin);
+
+    g_mutex_lock (&index_lock);
+    if (!index_loaded)
+        inspect_index_load ();
+    g_hash_table_replace (index_pending,
+                          g_strdup_printf ("%u:%s", pending->flags, pending->name), pending);
+    g_mutex_unlock (&index_lock);
+}
 
-    /* TODO: list what hooks it registers
-     * - the data is available in gsttracerutils, we need to iterate the
-     *   _priv_tracers hashtable for each probe and then check the list of hooks
-     *  for each probe whether hook->tracer == tracer :/
-     */
+static gint
+inspect_index_pending_compare (gconstpointer a, gconstpointer b)
+{
+    const InspectIndexPending *pa = *(const InspectIndexPending **) a;
+    const InspectIndexPending *pb = *(const InspectIndexPending **) b;
+    gint cmp = strcmp (pa->name, pb->name);
 
-    /* TODO: list what records it emits
-     * - in class_init tracers can create GstTracerRecord instances
-     * - those only get logged right now and there is no association with the
-     *   tracer that created them
-     * - we'd need to add them to GstTracerFactory
-     *   gst_tracer_class_add_record (klass, record);
-     *   - needs work in gstregistrychunks to (de)serialize specs
-     *   - gst_tracer_register() would need to iterate the list of records and
-     *     copy the record->spec into the factory
-     */
+    return cmp ? cmp : (gint) pa->flags - (gint) pb->flags;
+}
 
-    gst_object_unref (tracer);
-    gst_object_unref (factory);
-    g_free (_name);
-    return 0;
+static guint32
+inspect_index_blob_add (GByteArray * blob, const gchar * str, gsize len)
+{
+    guint32 offset = blob->len;
+
+    g_byte_array_append (blob, (const guint8 *) str, len);
+    g_byte_array_append (blob, (const guint8 *) "", 1);
+    return offset;
 }
 
-/* NOTE: Not coloring output from automatic install functions, as their output
- * is meant for machines, not humans.
- */
+/* Merge what was introspected during this run into the file on disk */
 static void
-print_plugin_automatic_install_info_codecs (GstElementFactory * factory)
+inspect_index_save (void)
 {
-    GstPadDirection direction;
-    const gchar *type_name;
-    const gchar *klass;
-    const GList *static_templates, *l;
-    GstCaps *caps = NULL;
-    guint i, num;
-
-    klass =
-            gst_element_factory_get_metadata (factory, GST_ELEMENT_METADATA_KLASS);
-    g_return_if_fail (klass != NULL);
+    GPtrArray *all;
+    GByteArray *blob;
+    InspectIndexHeader header = { INSPECT_INDEX_MAGIC, INSPECT_INDEX_VERSION, 0, 0 };
+    InspectIndexEntry *entries;
+    GError *error = NULL;
+    gsize table_size;
+    gchar *path, *contents;
+    guint i;
 
-    if (strstr (klass, "Demuxer") ||
-        strstr (klass, "Decoder") ||
-        strstr (klass, "Depay") || strstr (klass, "Parser")) {
-        type_name = "decoder";
-        direction = GST_PAD_SINK;
-    } else if (strstr (klass, "Muxer") ||
-               strstr (klass, "Encoder") || strstr (klass, "Pay")) {
-        type_name = "encoder";
-        direction = GST_PAD_SRC;
-    } else {
+    g_mutex_lock (&index_lock);
+    if (index_pending == NULL || g_hash_table_size (index_pending) == 0) {
+        g_mutex_unlock (&index_lock);
         return;
     }
 
-    /* decoder/demuxer sink pads should always be static and there should only
-     * be one, the same applies to encoders/muxers and source pads */
-    static_templates = gst_element_factory_get_static_pad_templates (factory);
-    for (l = static_templates; l != NULL; l = l->next) {
-        GstStaticPadTemplate *tmpl = NULL;
+    /* entries from the mapped file that were not redone this run */
+    all = g_ptr_array_new_with_free_func ((GDestroyNotify) inspect_index_pending_free);
+    for (i = 0; i < index_n_entries; i++) {
+        const InspectIndexEntry *entry = &index_entries[i];
+        const gchar *name = inspect_index_string (entry->name_offset);
+        const gchar *filename = inspect_index_string (entry->filename_offset);
+        InspectIndexPending *old;
+        gchar *key;
+
+        if (name == NULL || filename == NULL
+            || entry->text_offset > g_mapped_file_get_length (index_file)
+            || entry->text_len >
+               g_mapped_file_get_length (index_file) - entry->text_offset)
+            continue;
 
-        tmpl = (GstStaticPadTemplate *) l->data;
-        if (tmpl->direction == direction) {
-            caps = gst_static_pad_template_get_caps (tmpl);
-            break;
+        key = g_strdup_printf ("%u:%s", entry->flags, name);
+        if (!g_hash_table_contains (index_pending, key)) {
+            old = g_new0 (InspectIndexPending, 1);
+            old->name = g_strdup (name);
+            old->filename = g_strdup (filename);
+            old->text = g_strndup (g_mapped_file_get_contents (index_file) +
+                                   entry->text_offset, entry->text_len);
+            old->text_len = entry->text_len;
+            old->flags = entry->flags;
+            old->mtime = entry->mtime;
+            old->size = entry->size;
+            g_ptr_array_add (all, old);
         }
+        g_free (key);
     }
 
-    if (caps == NULL) {
-        g_printerr ("Couldn't find static pad template for %s '%s'\n",
-                    type_name, GST_OBJECT_NAME (factory));
-        return;
+    {
+        GHashTableIter iter;
+        gpointer key, value;
+
+        g_hash_table_iter_init (&iter, index_pending);
+        while (g_hash_table_iter_next (&iter, &key, &value)) {
+            g_ptr_array_add (all, value);
+            g_hash_table_iter_steal (&iter);
+            g_free (key);
+        }
+    }
+    g_ptr_array_sort (all, inspect_index_pending_compare);
+
+    header.n_entries = all->len;
+    table_size = sizeof (header) + all->len * sizeof (InspectIndexEntry);
+    entries = g_new0 (InspectIndexEntry, all->len);
+    blob = g_byte_array_new ();
+    for (i = 0; i < all->len; i++) {
+        InspectIndexPending *pending = g_ptr_array_index (all, i);
+
+        entries[i].name_offset = table_size +
+                inspect_index_blob_add (blob, pending->name, strlen (pending->name));
+        entries[i].filename_offset = table_size +
+                inspect_index_blob_add (blob, pending->filename,
+                                        strlen (pending->filename));
+        entries[i].text_offset = table_size +
+                inspect_index_blob_add (blob, pending->text, pending->text_len);
+        entries[i].text_len = pending->text_len;
+        entries[i].flags = pending->flags;
+        entries[i].mtime = pending->mtime;
+        entries[i].size = pending->size;
     }
 
-    caps = gst_caps_make_writable (caps);
-    num = gst_caps_get_size (caps);
-    for (i = 0; i < num; ++i) {
-        GstStructure *s;
-        gchar *s_str;
+    contents = g_malloc (table_size + blob->len);
+    memcpy (contents, &header, sizeof (header));
+    memcpy (contents + sizeof (header), entries,
+            all->len * sizeof (InspectIndexEntry));
+    memcpy (contents + table_size, blob->data, blob->len);
 
-        s = gst_caps_get_structure (caps, i);
-        /* remove fields that are almost always just MIN-MAX of some sort
-         * in order to make the caps look less messy */
-        gst_structure_remove_field (s, "pixel-aspect-ratio");
-        gst_structure_remove_field (s, "framerate");
-        gst_structure_remove_field (s, "channels");
-        gst_structure_remove_field (s, "width");
-        gst_structure_remove_field (s, "height");
-        gst_structure_remove_field (s, "rate");
-        gst_structure_remove_field (s, "depth");
-        gst_structure_remove_field (s, "clock-rate");
-        s_str = gst_structure_to_string (s);
-        g_print ("%s-%s\n", type_name, s_str);
-        g_free (s_str);
+    path = inspect_index_path ();
+    if (!g_file_set_contents (path, contents, table_size + blob->len, &error)) {
+        GST_WARNING ("Could not write inspect index %s: %s", path, error->message);
+        g_clear_error (&error);
+    } else {
+        GST_DEBUG ("Wrote inspect index with %u entries", all->len);
     }
-    gst_caps_unref (caps);
+
+    /* map the new file, dropping the old mapping everything was copied from */
+    if (index_file != NULL)
+        g_mapped_file_unref (index_file);
+    index_file = NULL;
+    index_entries = NULL;
+    index_n_entries = 0;
+    g_hash_table_unref (index_pending);
+    inspect_index_load ();
+    g_mutex_unlock (&index_lock);
+
+    g_free (path);
+    g_free (contents);
+    g_free (entries);
+    g_byte_array_unref (blob);
+    g_ptr_array_unref (all);
 }
 
-static void
-print_plugin_automatic_install_info_protocols (GstElementFactory * factory)
+static int print_element_info_uncached (GstPluginFeature * feature,
+                                        gboolean print_names);
+
+static int
+print_element_info (GstPluginFeature * feature, gboolean print_names)
 {
-    const gchar *const *protocols;
+    InspectOutput capture = { NULL, G_MAXSIZE, NULL, NULL };
+    InspectOutput *saved_output = output;
+    int ret;
 
-    protocols = gst_element_factory_get_uri_protocols (factory);
-    if (protocols != NULL && *protocols != NULL) {
-        switch (gst_element_factory_get_uri_type (factory)) {
-            case GST_URI_SINK:
-                while (*protocols != NULL) {
-                    g_print ("urisink-%s\n", *protocols);
-                    ++protocols;
-                }
-                break;
-            case GST_URI_SRC:
-                while (*protocols != NULL) {
-                    g_print ("urisource-%s\n", *protocols);
-                    ++protocols;
-                }
-                break;
-            default:
-                break;
-        }
+    if (inspect_index_bypass)
+        return print_element_info_uncached (feature, print_names);
+
+    if (inspect_index_print (feature, print_names))
+        return 0;
+
+    /* collect the output so that it can be indexed, then pass it on; the
+     * buffer is kept for the next element on this thread */
+    capture.str = g_private_get (&capture_str);
+    if (capture.str == NULL) {
+        capture.str = g_string_sized_new (OUTPUT_CHUNK_SIZE);
+        g_private_set (&capture_str, capture.str);
     }
+    g_string_truncate (capture.str, 0);
+    output = &capture;
+    ret = print_element_info_uncached (feature, print_names);
+    output = saved_output;
+
+    if (ret == 0)
+        inspect_index_add (feature, print_names, capture.str->str, capture.str->len);
+    inspect_output_write (capture.str->str, capture.str->len);
+
+    return ret;
 }
 
+/* Signals and presets take the longest to work out and don't change for a
+ * given element type, so their output is kept per factory (and color
+ * setting) for the life of the process */
+typedef void (*ElementSectionFunc) (GstElement * element);
+
+static GMutex section_lock;
+static GHashTable *section_memo = NULL;    /* "section:colors:factory" -> text */
+
+/* Print what @func prints for an element of @factory, from the memo if it
+ * was printed before. @element is created through @element_ptr if needed. */
 static void
-print_plugin_automatic_install_info (GstPlugin * plugin)
+print_section_memoized (guint section, GstElementFactory * factory,
+                        GstElement ** element_ptr, ElementSectionFunc func)
 {
-    GList *features, *l;
+    InspectOutput capture = { NULL, G_MAXSIZE, NULL, NULL };
+    InspectOutput *saved_output = output;
+    gchar *key, *text;
+
+    key = g_strdup_printf ("%u:%d:%s", section, colored_output,
+                           GST_OBJECT_NAME (factory));
+
+    g_mutex_lock (&section_lock);
+    if (section_memo == NULL)
+        section_memo = g_hash_table_new_full (g_str_hash, g_str_equal, g_free,
+                                              g_free);
+    text = g_strdup (g_hash_table_lookup (section_memo, key));
+    g_mutex_unlock (&section_lock);
+
+    if (text == NULL) {
+        if (*element_ptr == NULL)
+            *element_ptr = gst_element_factory_create (factory, NULL);
+        if (*element_ptr == NULL) {
+            g_free (key);
+            return;
+        }
 
-    /* not interested in typefind factories, only element factories */
-    features = gst_registry_get_feature_list (gst_registry_get (),
-                                              GST_TYPE_ELEMENT_FACTORY);
+        capture.str = g_string_new (NULL);
+        output = &capture;
+        func (*element_ptr);
+        output = saved_output;
+        text = g_string_free (capture.str, FALSE);
 
-    for (l = features; l != NULL; l = l->next) {
-        GstPluginFeature *feature;
-        GstPlugin *feature_plugin;
+        g_mutex_lock (&section_lock);
+        g_hash_table_replace (section_memo, key, g_strdup (text));
+        g_mutex_unlock (&section_lock);
+        key = NULL;
+    }
+
+    inspect_output_write (text, strlen (text));
+    g_free (text);
+    g_free (key);
+}
 
-        feature = GST_PLUGIN_FEATURE (l->data);
+/* Print the parts of the element info in @sections. The element is only
+ * instantiated when one of them needs it. */
+static int
+print_element_info_sections (GstPluginFeature * feature, gboolean print_names,
+                             guint sections)
+{
+    GstElementFactory *factory;
+    GstElement *element = NULL;
+    GstPlugin *plugin;
+    gint maxlevel = 0;
+    const guint needs_element = INSPECT_SECTION_PAD_TEMPLATES |
+            INSPECT_SECTION_CLOCKING | INSPECT_SECTION_URI_HANDLER |
+            INSPECT_SECTION_PADS | INSPECT_SECTION_PROPERTIES |
+            INSPECT_SECTION_CHILDREN;
 
-        /* only interested in the ones that are in the plugin we just loaded */
-        feature_plugin = gst_plugin_feature_get_plugin (feature);
-        if (feature_plugin == plugin) {
-            GstElementFactory *factory;
+    factory = GST_ELEMENT_FACTORY (gst_plugin_feature_load (feature));
+    if (!factory) {
+        g_print ("%selement plugin couldn't be loaded%s\n", DESC_COLOR,
+                 RESET_COLOR);
+        return -1;
+    }
 
-            g_print ("element-%s\n", gst_plugin_feature_get_name (feature));
+    if (sections & needs_element) {
+        element = gst_element_factory_create (factory, NULL);
+        if (!element) {
+            gst_object_unref (factory);
+            g_print ("%scouldn't construct element for some reason%s\n", DESC_COLOR,
+                     RESET_COLOR);
+            return -1;
+        }
+    }
 
-            factory = GST_ELEMENT_FACTORY (feature);
-            print_plugin_automatic_install_info_protocols (factory);
-            print_plugin_automatic_install_info_codecs (factory);
+    if (print_names)
+        _name =
+                g_strdup_printf ("%s%s%s: ", DATATYPE_COLOR, GST_OBJECT_NAME (factory),
+                                 RESET_COLOR);
+    else
+        _name = NULL;
+
+    if (sections & INSPECT_SECTION_DETAILS) {
+        print_factory_details_info (factory);
+
+        plugin = gst_plugin_feature_get_plugin (GST_PLUGIN_FEATURE (factory));
+        if (plugin) {
+            print_plugin_info (plugin);
+            gst_object_unref (plugin);
         }
-        if (feature_plugin)
-            gst_object_unref (feature_plugin);
     }
 
-    g_list_foreach (features, (GFunc) gst_object_unref, NULL);
-    g_list_free (features);
+    if (sections & INSPECT_SECTION_HIERARCHY)
+        print_hierarchy (gst_element_factory_get_element_type (factory), 0, &maxlevel);
+    if (sections & INSPECT_SECTION_INTERFACES)
+        print_interfaces (gst_element_factory_get_element_type (factory));
+
+    if (sections & INSPECT_SECTION_PAD_TEMPLATES)
+        print_pad_templates_info (element, factory);
+    if (sections & INSPECT_SECTION_CLOCKING)
+        print_clocking_info (element);
+    if (sections & INSPECT_SECTION_URI_HANDLER)
+        print_uri_handler_info (element);
+    if (sections & INSPECT_SECTION_PADS)
+        print_pad_info (element);
+    if (sections & INSPECT_SECTION_PROPERTIES)
+        print_element_properties_info (element);
+    if (sections & INSPECT_SECTION_SIGNALS)
+        print_section_memoized (INSPECT_SECTION_SIGNALS, factory, &element,
+                                print_signal_info);
+    if (sections & INSPECT_SECTION_CHILDREN)
+        print_children_info (element);
+    if (sections & INSPECT_SECTION_PRESETS)
+        print_section_memoized (INSPECT_SECTION_PRESETS, factory, &element,
+                                print_preset_list);
+
+    if (element)
+        gst_object_unref (element);
+    gst_object_unref (factory);
+    g_free (_name);
+    return 0;
 }
 
+/* --json: the element details as JSON lines, one object per section, so
+ * tools don't have to scrape the colored text. Every object has "element"
+ * and "section" members, the rest depends on the section. It is built in a
+ * single pass into one string, without going through n_print(). */
+
 static void
-print_all_plugin_automatic_install_info (void)
+json_append_string (GString * json, const gchar * str)
 {
-    GList *plugins, *orig_plugins;
+    const gchar *run;
 
-    orig_plugins = plugins = gst_registry_get_plugin_list (gst_registry_get ());
-    if (sort_output == SORT_TYPE_NAME)
-        plugins = g_list_sort (plugins, gst_plugin_name_compare_func);
-    while (plugins) {
-        GstPlugin *plugin;
+    if (str == NULL) {
+        g_string_append (json, "null");
+        return;
+    }
 
-        plugin = (GstPlugin *) (plugins->data);
-        plugins = g_list_next (plugins);
+    if (!g_utf8_validate (str, -1, NULL)) {
+        gchar *valid = g_utf8_make_valid (str, -1);
 
-        print_plugin_automatic_install_info (plugin);
+        json_append_string (json, valid);
+        g_free (valid);
+        return;
     }
-    gst_plugin_list_free (orig_plugins);
-}
 
-#ifdef G_OS_UNIX
-static gboolean
-redirect_stdout (void)
-{
-  GError *error = NULL;
-  gchar **argv;
-  const gchar *pager, *less;
-  gint stdin_fd;
-  gchar **envp;
+    g_string_append_c (json, '"');
+    for (run = str; *str; str++) {
+        guchar c = *str;
 
-  pager = g_getenv ("PAGER");
-  if (pager == NULL)
-    pager = DEFAULT_PAGER;
+        if (c >= 0x20 && c != '"' && c != '\\')
+            continue;
 
-  argv = g_strsplit (pager, " ", 0);
+        g_string_append_len (json, run, str - run);
+        switch (c) {
+            case '"':
+                g_string_append (json, "\\\"");
+                break;
+            case '\\':
+                g_string_append (json, "\\\\");
+                break;
+            case '\n':
+                g_string_append (json, "\\n");
+                break;
+            case '\t':
+                g_string_append (json, "\\t");
+                break;
+            default:
+                g_string_append_printf (json, "\\u%04x", c);
+                break;
+        }
+        run = str + 1;
+    }
+    g_string_append_len (json, run, str - run);
+    g_string_append_c (json, '"');
+}
 
-  less = g_getenv ("GST_LESS");
-  if (less == NULL)
-    less = DEFAULT_LESS_OPTS;
+/* A comma, unless a value can't have come before in this object or array */
+static void
+json_separate (GString * json)
+{
+    gchar last = json->len ? json->str[json->len - 1] : '\n';
 
-  envp = g_get_environ ();
-  envp = g_environ_setenv (envp, "LESS", less, TRUE);
+    if (last != '{' && last != '[' && last != ':' && last != '\n')
+        g_string_append_c (json, ',');
+}
 
-  if (!g_spawn_async_with_pipes (NULL, argv, envp,
-          G_SPAWN_DO_NOT_REAP_CHILD | G_SPAWN_SEARCH_PATH,
-          NULL, NULL, &child_pid, &stdin_fd,
-          /* pass null stdout/stderr to inherit our fds */
-          NULL, NULL, &error)) {
-    if (pager != DEFAULT_PAGER) {
-      g_warning ("g_spawn_async_with_pipes() failed: %s\n",
-          GST_STR_NULL (error->message));
-    }
-    g_strfreev (argv);
-    g_strfreev (envp);
-    g_clear_error (&error);
+static void
+json_key (GString * json, const gchar * key)
+{
+    json_separate (json);
+    json_append_string (json, key);
+    g_string_append_c (json, ':');
+}
 
-    return FALSE;
-  }
+/* Open an object or array, as member @key or as the next array item */
+static void
+json_open (GString * json, const gchar * key, gchar bracket)
+{
+    if (key != NULL)
+        json_key (json, key);
+    else
+        json_separate (json);
+    g_string_append_c (json, bracket);
+}
 
-  /* redirect our stdout to child stdin */
-  dup2 (stdin_fd, STDOUT_FILENO);
-  if (isatty (STDERR_FILENO))
-    dup2 (stdin_fd, STDERR_FILENO);
-  close (stdin_fd);
+static void
+json_member_string (GString * json, const gchar * key, const gchar * value)
+{
+    json_key (json, key);
+    json_append_string (json, value);
+}
 
-  g_strfreev (argv);
-  g_strfreev (envp);
+static void
+json_member_int (GString * json, const gchar * key, gint64 value)
+{
+    json_key (json, key);
+    g_string_append_printf (json, "%" G_GINT64_FORMAT, value);
+}
 
-  return TRUE;
+static void
+json_member_uint (GString * json, const gchar * key, guint64 value)
+{
+    json_key (json, key);
+    g_string_append_printf (json, "%" G_GUINT64_FORMAT, value);
 }
 
 static void
-child_exit_cb (GPid child_pid, gint status, gpointer user_data)
+json_member_bool (GString * json, const gchar * key, gboolean value)
 {
-  g_spawn_close_pid (child_pid);
-  g_main_loop_quit (loop);
+    json_key (json, key);
+    g_string_append (json, value ? "true" : "false");
+}
+
+static void
+json_append_double (GString * json, gdouble value)
+{
+    gchar buf[G_ASCII_DTOSTR_BUF_SIZE];
+
+    /* JSON has no NaN or infinity */
+    if (value != value || value > G_MAXDOUBLE || value < -G_MAXDOUBLE)
+        g_string_append (json, "null");
+    else
+        g_string_append (json, g_ascii_dtostr (buf, sizeof (buf), value));
+}
+
+static void
+json_member_double (GString * json, const gchar * key, gdouble value)
+{
+    json_key (json, key);
+    json_append_double (json, value);
+}
+
+/* Numbers, booleans and strings as such, enums and flags by nick, other
+ * types serialized the way gst_value_serialize() does, or null */
+static void
+json_append_value (GString * json, const GValue * value)
+{
+    GType type = G_VALUE_TYPE (value);
+    gpointer klass;
+    gchar *str;
+
+    switch (G_TYPE_FUNDAMENTAL (type)) {
+        case G_TYPE_BOOLEAN:
+            g_string_append (json, g_value_get_boolean (value) ? "true" : "false");
+            return;
+        case G_TYPE_CHAR:
+            g_string_append_printf (json, "%d", g_value_get_schar (value));
+            return;
+        case G_TYPE_UCHAR:
+            g_string_append_printf (json, "%u", g_value_get_uchar (value));
+            return;
+        case G_TYPE_INT:
+            g_string_append_printf (json, "%d", g_value_get_int (value));
+            return;
+        case G_TYPE_UINT:
+            g_string_append_printf (json, "%u", g_value_get_uint (value));
+            return;
+        case G_TYPE_LONG:
+            g_string_append_printf (json, "%ld", g_value_get_long (value));
+            return;
+        case G_TYPE_ULONG:
+            g_string_append_printf (json, "%lu", g_value_get_ulong (value));
+            return;
+        case G_TYPE_INT64:
+            g_string_append_printf (json, "%" G_GINT64_FORMAT,
+                                    g_value_get_int64 (value));
+            return;
+        case G_TYPE_UINT64:
+            g_string_append_printf (json, "%" G_GUINT64_FORMAT,
+                                    g_value_get_uint64 (value));
+            return;
+        case G_TYPE_FLOAT:
+            json_append_double (json, g_value_get_float (value));
+            return;
+        case G_TYPE_DOUBLE:
+            json_append_double (json, g_value_get_double (value));
+            return;
+        case G_TYPE_STRING:
+            json_append_string (json, g_value_get_string (value));
+            return;
+        case G_TYPE_ENUM:
+        {
+            GEnumValue *val = NULL;
+
+            klass = g_type_class_peek (type);
+            if (klass != NULL)
+                val = g_enum_get_value (klass, g_value_get_enum (value));
+            if (val != NULL)
+                json_append_string (json, val->value_nick);
+            else
+                g_string_append_printf (json, "%d", g_value_get_enum (value));
+            return;
+        }
+        case G_TYPE_FLAGS:
+            klass = g_type_class_peek (type);
+            if (klass == NULL) {
+                g_string_append_printf (json, "%u", g_value_get_flags (value));
+                return;
+            }
+            str = flags_to_string (((GFlagsClass *) klass)->values,
+                                   g_value_get_flags (value));
+            json_append_string (json, str);
+            g_free (str);
+            return;
+        case G_TYPE_OBJECT:
+        case G_TYPE_INTERFACE:
+        case G_TYPE_POINTER:
+        case G_TYPE_PARAM:
+            g_string_append (json, "null");
+            return;
+        default:
+            break;
+    }
+
+    str = gst_value_serialize (value);
+    json_append_string (json, str);
+    g_free (str);
+}
+
+static const struct
+{
+    GParamFlags flag;
+    const gchar *name;
+} json_param_flags[] = {
+        {G_PARAM_READABLE, "readable"},
+        {G_PARAM_WRITABLE, "writable"},
+        {G_PARAM_CONSTRUCT, "construct"},
+        {G_PARAM_CONSTRUCT_ONLY, "construct-only"},
+        {G_PARAM_DEPRECATED, "deprecated"},
+        {GST_PARAM_CONTROLLABLE, "controllable"},
+        {GST_PARAM_CONDITIONALLY_AVAILABLE, "conditionally-available"},
+        {GST_PARAM_MUTABLE_READY, "mutable-ready"},
+        {GST_PARAM_MUTABLE_PAUSED, "mutable-paused"},
+        {GST_PARAM_MUTABLE_PLAYING, "mutable-playing"},
+};
+
+static void
+json_append_param_flags (GString * json, GParamSpec * param)
+{
+    guint i;
+
+    json_open (json, "flags", '[');
+    for (i = 0; i < G_N_ELEMENTS (json_param_flags); i++) {
+        if (param->flags & json_param_flags[i].flag) {
+            json_separate (json);
+            json_append_string (json, json_param_flags[i].name);
+        }
+    }
+    g_string_append_c (json, ']');
+
+    if (param->flags & ~KNOWN_PARAM_FLAGS)
+        json_member_uint (json, "other-flags", param->flags & ~KNOWN_PARAM_FLAGS);
+}
+
+/* The range of numeric properties and the possible values of enums and
+ * flags */
+static void
+json_append_param_range (GString * json, GParamSpec * param)
+{
+    if (G_IS_PARAM_SPEC_INT (param)) {
+        json_member_int (json, "min", G_PARAM_SPEC_INT (param)->minimum);
+        json_member_int (json, "max", G_PARAM_SPEC_INT (param)->maximum);
+    } else if (G_IS_PARAM_SPEC_UINT (param)) {
+        json_member_uint (json, "min", G_PARAM_SPEC_UINT (param)->minimum);
+        json_member_uint (json, "max", G_PARAM_SPEC_UINT (param)->maximum);
+    } else if (G_IS_PARAM_SPEC_LONG (param)) {
+        json_member_int (json, "min", G_PARAM_SPEC_LONG (param)->minimum);
+        json_member_int (json, "max", G_PARAM_SPEC_LONG (param)->maximum);
+    } else if (G_IS_PARAM_SPEC_ULONG (param)) {
+        json_member_uint (json, "min", G_PARAM_SPEC_ULONG (param)->minimum);
+        json_member_uint (json, "max", G_PARAM_SPEC_ULONG (param)->maximum);
+    } else if (G_IS_PARAM_SPEC_INT64 (param)) {
+        json_member_int (json, "min", G_PARAM_SPEC_INT64 (param)->minimum);
+        json_member_int (json, "max", G_PARAM_SPEC_INT64 (param)->maximum);
+    } else if (G_IS_PARAM_SPEC_UINT64 (param)) {
+        json_member_uint (json, "min", G_PARAM_SPEC_UINT64 (param)->minimum);
+        json_member_uint (json, "max", G_PARAM_SPEC_UINT64 (param)->maximum);
+    } else if (G_IS_PARAM_SPEC_FLOAT (param)) {
+        json_member_double (json, "min", G_PARAM_SPEC_FLOAT (param)->minimum);
+        json_member_double (json, "max", G_PARAM_SPEC_FLOAT (param)->maximum);
+    } else if (G_IS_PARAM_SPEC_DOUBLE (param)) {
+        json_member_double (json, "min", G_PARAM_SPEC_DOUBLE (param)->minimum);
+        json_member_double (json, "max", G_PARAM_SPEC_DOUBLE (param)->maximum);
+    } else if (GST_IS_PARAM_SPEC_FRACTION (param)) {
+        GstParamSpecFraction *pfraction = GST_PARAM_SPEC_FRACTION (param);
+        gchar str[32];
+
+        g_snprintf (str, sizeof (str), "%d/%d", pfraction->min_num,
+                    pfraction->min_den);
+        json_member_string (json, "min", str);
+        g_snprintf (str, sizeof (str), "%d/%d", pfraction->max_num,
+                    pfraction->max_den);
+        json_member_string (json, "max", str);
+    } else if (G_IS_PARAM_SPEC_ENUM (param)) {
+        GEnumClass *klass = G_PARAM_SPEC_ENUM (param)->enum_class;
+        guint i;
+
+        json_open (json, "values", '[');
+        for (i = 0; i < klass->n_values; i++) {
+            json_open (json, NULL, '{');
+            json_member_int (json, "value", klass->values[i].value);
+            json_member_string (json, "name", klass->values[i].value_name);
+            json_member_string (json, "nick", klass->values[i].value_nick);
+            g_string_append_c (json, '}');
+        }
+        g_string_append_c (json, ']');
+    } else if (G_IS_PARAM_SPEC_FLAGS (param)) {
+        GFlagsClass *klass = G_PARAM_SPEC_FLAGS (param)->flags_class;
+        guint i;
+
+        json_open (json, "values", '[');
+        for (i = 0; i < klass->n_values; i++) {
+            json_open (json, NULL, '{');
+            json_member_uint (json, "value", klass->values[i].value);
+            json_member_string (json, "name", klass->values[i].value_name);
+            json_member_string (json, "nick", klass->values[i].value_nick);
+            g_string_append_c (json, '}');
+        }
+        g_string_append_c (json, ']');
+    }
+}
+
+/* obj will be NULL for the properties of pad template pads, which then
+ * only have their defaults */
+static void
+json_append_properties (GString * json, GObject * obj, GObjectClass * obj_class)
+{
+    GParamSpec **property_specs;
+    guint num_properties, i;
+
+    property_specs = list_properties_sorted (obj_class, &num_properties);
+
+    json_open (json, "properties", '[');
+    for (i = 0; i < num_properties; i++) {
+        GParamSpec *param = property_specs[i];
+        GType owner_type = param->owner_type;
+
+        if (obj == NULL && (owner_type == G_TYPE_OBJECT
+                            || owner_type == GST_TYPE_OBJECT || owner_type == GST_TYPE_PAD))
+            continue;
+
+        json_open (json, NULL, '{');
+        json_member_string (json, "name", g_param_spec_get_name (param));
+        json_member_string (json, "nick", g_param_spec_get_nick (param));
+        json_member_string (json, "blurb", g_param_spec_get_blurb (param));
+        json_member_string (json, "type", g_type_name (param->value_type));
+        json_member_string (json, "owner", g_type_name (owner_type));
+        json_append_param_flags (json, param);
+        json_key (json, "default");
+        json_append_value (json, g_param_spec_get_default_value (param));
+
+        if ((param->flags & G_PARAM_READABLE) && obj != NULL) {
+            GValue value = G_VALUE_INIT;
+
+            g_value_init (&value, param->value_type);
+            g_object_get_property (obj, param->name, &value);
+            json_key (json, "value");
+            json_append_value (json, &value);
+            g_value_unset (&value);
+        }
+
+        json_append_param_range (json, param);
+        g_string_append_c (json, '}');
+    }
+    g_string_append_c (json, ']');
+}
+
+static const gchar *
+json_pad_direction (GstPadDirection direction)
+{
+    if (direction == GST_PAD_SRC)
+        return "src";
+    if (direction == GST_PAD_SINK)
+        return "sink";
+    return "unknown";
+}
+
+static void
+json_append_factory_details (GString * json, GstElementFactory * factory)
+{
+    GstRank rank = gst_plugin_feature_get_rank (GST_PLUGIN_FEATURE (factory));
+    GstPlugin *plugin;
+    gchar **keys, **k;
+    char s[40];
+
+    json_member_int (json, "rank", rank);
+    json_member_string (json, "rank-name", get_rank_name (s, rank));
+
+    json_open (json, "metadata", '{');
+    keys = gst_element_factory_get_metadata_keys (factory);
+    if (keys != NULL) {
+        for (k = keys; *k != NULL; ++k)
+            json_member_string (json, *k,
+                                gst_element_factory_get_metadata (factory, *k));
+        g_strfreev (keys);
+    }
+    g_string_append_c (json, '}');
+
+    plugin = gst_plugin_feature_get_plugin (GST_PLUGIN_FEATURE (factory));
+    json_key (json, "plugin");
+    if (plugin == NULL) {
+        g_string_append (json, "null");
+        return;
+    }
+    g_string_append_c (json, '{');
+    json_member_string (json, "name", gst_plugin_get_name (plugin));
+    json_member_string (json, "description", gst_plugin_get_description (plugin));
+    json_member_string (json, "filename", gst_plugin_get_filename (plugin));
+    json_member_string (json, "version", gst_plugin_get_version (plugin));
+    json_member_string (json, "license", gst_plugin_get_license (plugin));
+    json_member_string (json, "source", gst_plugin_get_source (plugin));
+    json_member_string (json, "release-date",
+                        gst_plugin_get_release_date_string (plugin));
+    json_member_string (json, "package", gst_plugin_get_package (plugin));
+    json_member_string (json, "origin", gst_plugin_get_origin (plugin));
+    g_string_append_c (json, '}');
+    gst_object_unref (plugin);
+}
+
+/* Root type first, like print_hierarchy() */
+static void
+json_append_hierarchy (GString * json, GType type)
+{
+    GType parent = g_type_parent (type);
+
+    if (parent)
+        json_append_hierarchy (json, parent);
+    json_separate (json);
+    json_append_string (json, g_type_name (type));
+}
+
+static void
+json_append_interfaces (GString * json, GType type)
+{
+    guint n_ifaces, i;
+    GType *ifaces = g_type_interfaces (type, &n_ifaces);
+
+    json_open (json, "interfaces", '[');
+    for (i = 0; i < n_ifaces; i++) {
+        json_separate (json);
+        json_append_string (json, g_type_name (ifaces[i]));
+    }
+    g_string_append_c (json, ']');
+    g_free (ifaces);
+}
+
+static void
+json_append_pad_templates (GString * json, GstElement * element,
+                           GstElementFactory * factory)
+{
+    GList *pads, *l;
+
+    pads = g_list_copy ((GList *)
+                                gst_element_factory_get_static_pad_templates (factory));
+    pads = g_list_sort (pads, gst_static_pad_compare_func);
+
+    json_open (json, "templates", '[');
+    for (l = pads; l; l = l->next) {
+        GstStaticPadTemplate *padtemplate = (GstStaticPadTemplate *) l->data;
+        GstPadTemplate *tmpl;
+        const gchar *presence;
+
+        if (padtemplate->presence == GST_PAD_ALWAYS)
+            presence = "always";
+        else if (padtemplate->presence == GST_PAD_SOMETIMES)
+            presence = "sometimes";
+        else if (padtemplate->presence == GST_PAD_REQUEST)
+            presence = "request";
+        else
+            presence = "unknown";
+
+        json_open (json, NULL, '{');
+        json_member_string (json, "name", padtemplate->name_template);
+        json_member_string (json, "direction",
+                            json_pad_direction (padtemplate->direction));
+        json_member_string (json, "presence", presence);
+        json_member_string (json, "caps", padtemplate->static_caps.string);
+
+        tmpl = gst_element_class_get_pad_template (GST_ELEMENT_GET_CLASS (element),
+                                                   padtemplate->name_template);
+        if (tmpl != NULL) {
+            GType pad_type = GST_PAD_TEMPLATE_GTYPE (tmpl);
+
+            if (pad_type != G_TYPE_NONE && pad_type != GST_TYPE_PAD) {
+                gpointer pad_klass = g_type_class_ref (pad_type);
+
+                json_member_string (json, "type", g_type_name (pad_type));
+                json_append_properties (json, NULL, pad_klass);
+                g_type_class_unref (pad_klass);
+            }
+        }
+        g_string_append_c (json, '}');
+    }
+    g_string_append_c (json, ']');
+    g_list_free (pads);
+}
+
+static void
+json_append_clocking (GString * json, GstElement * element)
+{
+    gboolean provides_clock =
+            GST_OBJECT_FLAG_IS_SET (element, GST_ELEMENT_FLAG_PROVIDE_CLOCK);
+
+    json_member_bool (json, "requires-clock",
+                      GST_OBJECT_FLAG_IS_SET (element, GST_ELEMENT_FLAG_REQUIRE_CLOCK));
+    json_member_bool (json, "provides-clock", provides_clock);
+    if (provides_clock) {
+        GstClock *clock = gst_element_get_clock (element);
+
+        json_member_string (json, "clock", clock ? GST_OBJECT_NAME (clock) : NULL);
+        if (clock)
+            gst_object_unref (clock);
+    }
+}
+
+static void
+json_append_uri_handler (GString * json, GstElement * element)
+{
+    const gchar *const *uri_protocols = NULL;
+    const gchar *uri_type = NULL;
+
+    if (GST_IS_URI_HANDLER (element)) {
+        GstURIType type = gst_uri_handler_get_uri_type (GST_URI_HANDLER (element));
+
+        if (type == GST_URI_SRC)
+            uri_type = "source";
+        else if (type == GST_URI_SINK)
+            uri_type = "sink";
+        else
+            uri_type = "unknown";
+        uri_protocols = gst_uri_handler_get_protocols (GST_URI_HANDLER (element));
+    }
+
+    json_member_string (json, "uri-type", uri_type);
+    json_open (json, "protocols", '[');
+    for (; uri_protocols && *uri_protocols; uri_protocols++) {
+        json_separate (json);
+        json_append_string (json, *uri_protocols);
+    }
+    g_string_append_c (json, ']');
+}
+
+static void
+json_append_pads (GString * json, GstElement * element)
+{
+    const GList *pads;
+
+    json_open (json, "pads", '[');
+    for (pads = element->pads; pads; pads = pads->next) {
+        GstPad *pad = GST_PAD (pads->data);
+        GstCaps *caps = gst_pad_get_current_caps (pad);
+        gchar *str;
+
+        json_open (json, NULL, '{');
+        json_member_string (json, "name", GST_PAD_NAME (pad));
+        json_member_string (json, "direction",
+                            json_pad_direction (gst_pad_get_direction (pad)));
+        json_member_string (json, "template",
+                            pad->padtemplate ? pad->padtemplate->name_template : NULL);
+        str = caps ? gst_caps_to_string (caps) : NULL;
+        json_member_string (json, "caps", str);
+        g_free (str);
+        if (caps)
+            gst_caps_unref (caps);
+        g_string_append_c (json, '}');
+    }
+    g_string_append_c (json, ']');
+}
+
+static void
+json_append_signal (GString * json, guint signal_id)
+{
+    GSignalQuery query;
+    guint i;
+
+    g_signal_query (signal_id, &query);
+    if (query.signal_id == 0)
+        return;
+
+    json_open (json, NULL, '{');
+    json_member_string (json, "name", query.signal_name);
+    json_member_string (json, "class", g_type_name (query.itype));
+    json_member_string (json, "return",
+                        g_type_name (query.return_type & ~G_SIGNAL_TYPE_STATIC_SCOPE));
+    json_open (json, "params", '[');
+    for (i = 0; i < query.n_params; i++) {
+        json_separate (json);
+        json_append_string (json,
+                            g_type_name (query.param_types[i] & ~G_SIGNAL_TYPE_STATIC_SCOPE));
+    }
+    g_string_append_c (json, ']');
+    json_member_bool (json, "action", query.signal_flags & G_SIGNAL_ACTION);
+    g_string_append_c (json, '}');
+}
+
+/* Signals and actions together, told apart by "action". The same ones as
+ * print_signal_info() lists, found from the factory alone. */
+static void
+json_append_signals (GString * json, GstElementFactory * factory)
+{
+    GType element_type = gst_element_factory_get_element_type (factory);
+    const GList *l;
+    GType type;
+    guint *signals, nsignals, i;
+
+    json_open (json, "signals", '[');
+
+    for (l = gst_element_factory_get_static_pad_templates (factory); l;
+         l = l->next) {
+        if (((GstStaticPadTemplate *) l->data)->presence == GST_PAD_SOMETIMES) {
+            json_append_signal (json,
+                                g_signal_lookup ("pad-added", GST_TYPE_ELEMENT));
+            json_append_signal (json,
+                                g_signal_lookup ("pad-removed", GST_TYPE_ELEMENT));
+            json_append_signal (json,
+                                g_signal_lookup ("no-more-pads", GST_TYPE_ELEMENT));
+            break;
+        }
+    }
+
+    for (type = element_type; type; type = g_type_parent (type)) {
+        if (type == GST_TYPE_ELEMENT || type == GST_TYPE_OBJECT)
+            break;
+
+        if (type == GST_TYPE_BIN && element_type != GST_TYPE_BIN)
+            continue;
+
+        signals = g_signal_list_ids (type, &nsignals);
+        for (i = 0; i < nsignals; i++)
+            json_append_signal (json, signals[i]);
+        g_free (signals);
+    }
+
+    g_string_append_c (json, ']');
+}
+
+static void
+json_append_children (GString * json, GstElement * element)
+{
+    GList *children = GST_IS_BIN (element) ? GST_BIN (element)->children : NULL;
+
+    json_open (json, "children", '[');
+    for (; children; children = children->next) {
+        json_separate (json);
+        json_append_string (json, GST_ELEMENT_NAME (children->data));
+    }
+    g_string_append_c (json, ']');
+}
+
+static void
+json_append_presets (GString * json, GstElement * element)
+{
+    gchar **presets = NULL, **preset;
+
+    if (GST_IS_PRESET (element))
+        presets = gst_preset_get_preset_names (GST_PRESET (element));
+
+    json_open (json, "presets", '[');
+    for (preset = presets; preset && *preset; preset++) {
+        gchar *comment = NULL;
+
+        gst_preset_get_meta (GST_PRESET (element), *preset, "comment", &comment);
+        json_open (json, NULL, '{');
+        json_member_string (json, "name", *preset);
+        json_member_string (json, "comment", comment);
+        g_string_append_c (json, '}');
+        g_free (comment);
+    }
+    g_string_append_c (json, ']');
+    g_strfreev (presets);
+}
+
+static void
+json_section_open (GString * json, const gchar * element, const gchar * section)
+{
+    g_string_append (json, "{\"element\":");
+    json_append_string (json, element);
+    json_member_string (json, "section", section);
+}
+
+static void
+json_section_close (GString * json)
+{
+    g_string_append (json, "}\n");
+}
+
+/* The JSON counterpart of print_element_info_sections() */
+static int
+print_element_json (GstPluginFeature * feature, guint sections)
+{
+    GstElementFactory *factory;
+    GstElement *element = NULL;
+    GString *json = g_string_sized_new (4096);
+    const gchar *name = GST_OBJECT_NAME (feature);
+    const guint needs_element = INSPECT_SECTION_PAD_TEMPLATES |
+            INSPECT_SECTION_CLOCKING | INSPECT_SECTION_URI_HANDLER |
+            INSPECT_SECTION_PADS | INSPECT_SECTION_PROPERTIES |
+            INSPECT_SECTION_CHILDREN | INSPECT_SECTION_PRESETS;
+    int ret = 0;
+
+    factory = GST_ELEMENT_FACTORY (gst_plugin_feature_load (feature));
+    if (!factory) {
+        json_section_open (json, name, "error");
+        json_member_string (json, "message", "element plugin couldn't be loaded");
+        json_section_close (json);
+        ret = -1;
+        goto done;
+    }
+
+    if (sections & needs_element) {
+        element = gst_element_factory_create (factory, NULL);
+        if (!element) {
+            json_section_open (json, name, "error");
+            json_member_string (json, "message",
+                                "couldn't construct element for some reason");
+            json_section_close (json);
+            gst_object_unref (factory);
+            ret = -1;
+            goto done;
+        }
+    }
+
+    if (sections & INSPECT_SECTION_DETAILS) {
+        json_section_open (json, name, "details");
+        json_append_factory_details (json, factory);
+        json_section_close (json);
+    }
+    if (sections & INSPECT_SECTION_HIERARCHY) {
+        json_section_open (json, name, "hierarchy");
+        json_open (json, "types", '[');
+        json_append_hierarchy (json, gst_element_factory_get_element_type (factory));
+        g_string_append_c (json, ']');
+        json_section_close (json);
+    }
+    if (sections & INSPECT_SECTION_INTERFACES) {
+        json_section_open (json, name, "interfaces");
+        json_append_interfaces (json, gst_element_factory_get_element_type (factory));
+        json_section_close (json);
+    }
+    if (sections & INSPECT_SECTION_PAD_TEMPLATES) {
+        json_section_open (json, name, "pad-templates");
+        json_append_pad_templates (json, element, factory);
+        json_section_close (json);
+    }
+    if (sections & INSPECT_SECTION_CLOCKING) {
+        json_section_open (json, name, "clocking");
+        json_append_clocking (json, element);
+        json_section_close (json);
+    }
+    if (sections & INSPECT_SECTION_URI_HANDLER) {
+        json_section_open (json, name, "uri-handler");
+        json_append_uri_handler (json, element);
+        json_section_close (json);
+    }
+    if (sections & INSPECT_SECTION_PADS) {
+        json_section_open (json, name, "pads");
+        json_append_pads (json, element);
+        json_section_close (json);
+    }
+    if (sections & INSPECT_SECTION_PROPERTIES) {
+        json_section_open (json, name, "properties");
+        json_append_properties (json, G_OBJECT (element),
+                                G_OBJECT_GET_CLASS (element));
+        json_section_close (json);
+    }
+    if (sections & INSPECT_SECTION_SIGNALS) {
+        json_section_open (json, name, "signals");
+        json_append_signals (json, factory);
+        json_section_close (json);
+    }
+    if (sections & INSPECT_SECTION_CHILDREN) {
+        json_section_open (json, name, "children");
+        json_append_children (json, element);
+        json_section_close (json);
+    }
+    if (sections & INSPECT_SECTION_PRESETS) {
+        json_section_open (json, name, "presets");
+        json_append_presets (json, element);
+        json_section_close (json);
+    }
+
+    if (element)
+        gst_object_unref (element);
+    gst_object_unref (factory);
+
+    done:
+    inspect_output_write (json->str, json->len);
+    g_string_free (json, TRUE);
+    return ret;
+}
+
+static int
+print_element_info_uncached (GstPluginFeature * feature, gboolean print_names)
+{
+    if (inspect_json)
+        return print_element_json (feature, inspect_sections);
+    return print_element_info_sections (feature, print_names, inspect_sections);
+}
+
+static int
+print_typefind_info (GstPluginFeature * feature, gboolean print_names)
+{
+    GstTypeFindFactory *factory;
+    GstPlugin *plugin;
+    GstCaps *caps;
+    GstRank rank;
+    char s[40];
+    const gchar *const *extensions;
+
+    factory = GST_TYPE_FIND_FACTORY (gst_plugin_feature_load (feature));
+    if (!factory) {
+        g_print ("%stypefind plugin couldn't be loaded%s\n", DESC_COLOR,
+                 RESET_COLOR);
+        return -1;
+    }
+
+    if (print_names)
+        _name =
+                g_strdup_printf ("%s%s%s: ", DATATYPE_COLOR, GST_OBJECT_NAME (factory),
+                                 RESET_COLOR);
+    else
+        _name = NULL;
+
+    n_print ("%sFactory Details%s:\n", HEADING_COLOR, RESET_COLOR);
+    rank = gst_plugin_feature_get_rank (feature);
+    n_print ("  %s%-25s%s%s (%d)%s\n", PROP_NAME_COLOR, "Rank", PROP_VALUE_COLOR,
+             get_rank_name (s, rank), rank, RESET_COLOR);
+    n_print ("  %s%-25s%s%s%s\n", PROP_NAME_COLOR, "Name", PROP_VALUE_COLOR,
+             GST_OBJECT_NAME (factory), RESET_COLOR);
+    caps = gst_type_find_factory_get_caps (factory);
+    if (caps) {
+        gchar *caps_str = gst_caps_to_string (factory->caps);
+
+        n_print ("  %s%-25s%s%s%s\n", PROP_NAME_COLOR, "Caps", PROP_VALUE_COLOR,
+                 caps_str, RESET_COLOR);
+        g_free (caps_str);
+    }
+    extensions = gst_type_find_factory_get_extensions (factory);
+    if (extensions) {
+        n_print ("  %s%-25s%s", PROP_NAME_COLOR, "Extensions", RESET_COLOR);
+        print_typefind_extensions (extensions, PROP_VALUE_COLOR);
+        n_print ("\n");
+    }
+    n_print ("\n");
+
+    plugin = gst_plugin_feature_get_plugin (GST_PLUGIN_FEATURE (factory));
+    if (plugin) {
+        print_plugin_info (plugin);
+        gst_object_unref (plugin);
+    }
+
+    gst_object_unref (factory);
+    g_free (_name);
+    return 0;
+}
+
+static int
+print_tracer_info (GstPluginFeature * feature, gboolean print_names)
+{
+    GstTracerFactory *factory;
+    GstTracer *tracer;
+    GstPlugin *plugin;
+    gint maxlevel = 0;
+
+    factory = GST_TRACER_FACTORY (gst_plugin_feature_load (feature));
+    if (!factory) {
+        g_print ("%stracer plugin couldn't be loaded%s\n", DESC_COLOR, RESET_COLOR);
+        return -1;
+    }
+
+    tracer = (GstTracer *) g_object_new (factory->type, NULL);
+    if (!tracer) {
+        gst_object_unref (factory);
+        g_print ("%scouldn't construct tracer for some reason%s\n", DESC_COLOR,
+                 RESET_COLOR);
+        return -1;
+    }
+
+    if (print_names)
+        _name =
+                g_strdup_printf ("%s%s%s: ", DATATYPE_COLOR, GST_OBJECT_NAME (factory),
+                                 RESET_COLOR);
+    else
+        _name = NULL;
+
+    n_print ("%sFactory Details%s:\n", HEADING_COLOR, RESET_COLOR);
+    n_print ("  %s%-25s%s%s%s\n", PROP_NAME_COLOR, "Name", PROP_VALUE_COLOR,
+             GST_OBJECT_NAME (factory), RESET_COLOR);
+    n_print ("\n");
+
+    plugin = gst_plugin_feature_get_plugin (GST_PLUGIN_FEATURE (factory));
+    if (plugin) {
+        print_plugin_info (plugin);
+        gst_object_unref (plugin);
+    }
+
+    print_hierarchy (G_OBJECT_TYPE (tracer), 0, &maxlevel);
+    print_interfaces (G_OBJECT_TYPE (tracer));
+
+    /* TODO: list what hooks it registers
+     * - the data is available in gsttracerutils, we need to iterate the
+     *   _priv_tracers hashtable for each probe and then check the list of hooks
+     *  for each probe whether hook->tracer == tracer :/
+     */
+
+    /* TODO: list what records it emits
+     * - in class_init tracers can create GstTracerRecord instances
+     * - those only get logged right now and there is no association with the
+     *   tracer that created them
+     * - we'd need to add them to GstTracerFactory
+     *   gst_tracer_class_add_record (klass, record);
+     *   - needs work in gstregistrychunks to (de)serialize specs
+     *   - gst_tracer_register() would need to iterate the list of records and
+     *     copy the record->spec into the factory
+     */
+
+    gst_object_unref (tracer);
+    gst_object_unref (factory);
+    g_free (_name);
+    return 0;
+}
+
+/* Devices found by each provider, kept for a little while: starting a
+ * provider can take hundreds of milliseconds, e.g. on camera HALs, and the
+ * devices hardly change between two inspections */
+#define PROBE_CACHE_TTL (10 * G_TIME_SPAN_SECOND)
+
+typedef struct
+{
+    gint64 probed_at;           /* Monotonic time */
+    GList *devices;             /* GstDevice, owned */
+} ProbeResult;
+
+static GMutex probe_lock;
+static GHashTable *probe_cache = NULL;  /* Factory name -> ProbeResult */
+
+static void
+probe_result_free (ProbeResult * result)
+{
+    g_list_free_full (result->devices, gst_object_unref);
+    g_free (result);
+}
+
+/* The devices @provider exposes, from the cache when it is recent enough.
+ * Returns a new list of new references. */
+static GList *
+probe_devices (GstDeviceProvider * provider, const gchar * name, gint64 * age)
+{
+    gint64 now = g_get_monotonic_time ();
+    ProbeResult *result;
+    GList *devices;
+
+    g_mutex_lock (&probe_lock);
+    if (probe_cache == NULL)
+        probe_cache = g_hash_table_new_full (g_str_hash, g_str_equal, g_free,
+                                             (GDestroyNotify) probe_result_free);
+
+    result = g_hash_table_lookup (probe_cache, name);
+    if (result == NULL || now - result->probed_at > PROBE_CACHE_TTL) {
+        result = g_new0 (ProbeResult, 1);
+        /* providers that can only monitor have to be started to list anything */
+        result->devices = gst_device_provider_get_devices (provider);
+        if (result->devices == NULL && gst_device_provider_start (provider)) {
+            result->devices = gst_device_provider_get_devices (provider);
+            gst_device_provider_stop (provider);
+        }
+        result->probed_at = g_get_monotonic_time ();
+        GST_INFO ("Probed %s in %" G_GINT64_FORMAT " ms", name,
+                  (result->probed_at - now) / 1000);
+        g_hash_table_insert (probe_cache, g_strdup (name), result);
+    }
+
+    *age = MAX (now - result->probed_at, 0);
+    devices = g_list_copy_deep (result->devices, (GCopyFunc) gst_object_ref, NULL);
+    g_mutex_unlock (&probe_lock);
+
+    return devices;
+}
+
+static void
+print_device_info (GstDevice * device)
+{
+    gchar *name = gst_device_get_display_name (device);
+    gchar *device_class = gst_device_get_device_class (device);
+    GstCaps *caps = gst_device_get_caps (device);
+    GstStructure *props = gst_device_get_properties (device);
+
+    n_print ("%s%s%s:\n", DATATYPE_COLOR, name, RESET_COLOR);
+    push_indent ();
+    n_print ("%s%-25s%s%s%s\n", PROP_NAME_COLOR, "Class", PROP_VALUE_COLOR,
+             device_class, RESET_COLOR);
+    if (caps) {
+        n_print ("%sCaps:%s\n", PROP_NAME_COLOR, RESET_COLOR);
+        push_indent ();
+        print_caps (caps, "");
+        pop_indent ();
+        gst_caps_unref (caps);
+    }
+    if (props) {
+        n_print ("%sProperties:%s\n", PROP_NAME_COLOR, RESET_COLOR);
+        push_indent ();
+        gst_structure_foreach (props, print_field, (gpointer) "");
+        pop_indent ();
+        gst_structure_free (props);
+    }
+    pop_indent ();
+
+    g_free (device_class);
+    g_free (name);
+}
+
+static int
+print_device_provider_info (GstPluginFeature * feature, gboolean print_names)
+{
+    GstDeviceProviderFactory *factory;
+    GstDeviceProvider *provider;
+    GstPlugin *plugin;
+    gchar **keys, **k, **hidden;
+    GList *devices, *l;
+    GstRank rank;
+    gint64 age;
+    gint maxlevel = 0;
+    char s[40];
+
+    factory = GST_DEVICE_PROVIDER_FACTORY (gst_plugin_feature_load (feature));
+    if (!factory) {
+        g_print ("%sdevice provider plugin couldn't be loaded%s\n", DESC_COLOR,
+                 RESET_COLOR);
+        return -1;
+    }
+
+    provider = gst_device_provider_factory_get (factory);
+    if (!provider) {
+        gst_object_unref (factory);
+        g_print ("%scouldn't construct device provider for some reason%s\n",
+                 DESC_COLOR, RESET_COLOR);
+        return -1;
+    }
+
+    if (print_names)
+        _name =
+                g_strdup_printf ("%s%s%s: ", DATATYPE_COLOR, GST_OBJECT_NAME (factory),
+                                 RESET_COLOR);
+    else
+        _name = NULL;
+
+    rank = gst_plugin_feature_get_rank (GST_PLUGIN_FEATURE (factory));
+    n_print ("%sFactory Details:%s\n", HEADING_COLOR, RESET_COLOR);
+    push_indent ();
+    n_print ("%s%-25s%s%s (%d)%s\n", PROP_NAME_COLOR, "Rank", PROP_VALUE_COLOR,
+             get_rank_name (s, rank), rank, RESET_COLOR);
+    keys = gst_device_provider_factory_get_metadata_keys (factory);
+    if (keys != NULL) {
+        for (k = keys; *k != NULL; ++k) {
+            const gchar *val;
+            gchar *key = *k;
+
+            val = gst_device_provider_factory_get_metadata (factory, key);
+            key[0] = g_ascii_toupper (key[0]);
+            n_print ("%s%-25s%s%s%s\n", PROP_NAME_COLOR, key, PROP_VALUE_COLOR, val,
+                     RESET_COLOR);
+        }
+        g_strfreev (keys);
+    }
+    hidden = gst_device_provider_get_hidden_providers (provider);
+    if (hidden != NULL && *hidden != NULL) {
+        gchar *list = g_strjoinv (", ", hidden);
+
+        n_print ("%s%-25s%s%s%s\n", PROP_NAME_COLOR, "Hides", PROP_VALUE_COLOR,
+                 list, RESET_COLOR);
+        g_free (list);
+    }
+    g_strfreev (hidden);
+    pop_indent ();
+    n_print ("\n");
+
+    plugin = gst_plugin_feature_get_plugin (GST_PLUGIN_FEATURE (factory));
+    if (plugin) {
+        print_plugin_info (plugin);
+        gst_object_unref (plugin);
+    }
+
+    print_hierarchy (G_OBJECT_TYPE (provider), 0, &maxlevel);
+    print_interfaces (G_OBJECT_TYPE (provider));
+
+    g_print ("\n");
+    print_object_properties_info (G_OBJECT (provider),
+                                  G_OBJECT_GET_CLASS (provider), "Device Provider Properties");
+
+    devices = probe_devices (provider, GST_OBJECT_NAME (factory), &age);
+    g_print ("\n");
+    n_print ("%sDevices%s (probed %.1f s ago):\n", HEADING_COLOR, RESET_COLOR,
+             age / (gdouble) G_TIME_SPAN_SECOND);
+    push_indent ();
+    if (devices == NULL)
+        n_print ("none\n");
+    for (l = devices; l != NULL; l = l->next)
+        print_device_info (GST_DEVICE (l->data));
+    pop_indent ();
+    g_list_free_full (devices, gst_object_unref);
+
+    gst_object_unref (provider);
+    gst_object_unref (factory);
+    g_free (_name);
+    return 0;
+}
+
+/* Automatic install info index: the install details of every element
+ * factory ("element-", "decoder-", "encoder-", "urisource-" and "urisink-"
+ * strings), worked out from the registry once and rebuilt when its
+ * feature list changes. It gives both the lines printed for each factory
+ * and, keyed by detail type and caps name or protocol, the factories that
+ * provide a detail, so "is there a decoder for X" is a hash lookup. */
+typedef struct
+{
+    GstElementFactory *factory;
+    guint rank;
+    GstCaps *caps;              /* For codecs, the caps the detail was made from */
+} AiiProvider;
+
+typedef struct
+{
+    gchar *lines;               /* What --print-plugin-auto-install-info prints */
+    gchar *error;               /* For stderr, or NULL */
+} AiiFactory;
+
+typedef struct
+{
+    guint32 cookie;             /* Feature list cookie the index was built for */
+    GHashTable *factories;      /* Factory name -> AiiFactory */
+    GHashTable *providers;      /* "decoder-video/x-h264", "urisource-http",
+                                 * ... -> GPtrArray of AiiProvider */
+} AiiIndex;
+
+static GMutex aii_lock;
+static AiiIndex *aii_index = NULL;
+
+static void
+aii_factory_free (AiiFactory * entry)
+{
+    g_free (entry->lines);
+    g_free (entry->error);
+    g_free (entry);
+}
+
+static void
+aii_provider_free (AiiProvider * provider)
+{
+    gst_object_unref (provider->factory);
+    if (provider->caps)
+        gst_caps_unref (provider->caps);
+    g_free (provider);
+}
+
+static void
+aii_index_free (AiiIndex * index)
+{
+    g_hash_table_unref (index->factories);
+    g_hash_table_unref (index->providers);
+    g_free (index);
+}
+
+/* Highest rank first, then by name */
+static gint
+aii_provider_compare (gconstpointer a, gconstpointer b)
+{
+    const AiiProvider *pa = *(const AiiProvider **) a;
+    const AiiProvider *pb = *(const AiiProvider **) b;
+
+    if (pa->rank != pb->rank)
+        return pa->rank > pb->rank ? -1 : 1;
+    return strcmp (GST_OBJECT_NAME (pa->factory), GST_OBJECT_NAME (pb->factory));
+}
+
+/* @caps is taken over */
+static void
+aii_index_add (AiiIndex * index, const gchar * type, const gchar * name,
+               GstElementFactory * factory, GstCaps * caps)
+{
+    gchar *key = g_strconcat (type, "-", name, NULL);
+    GPtrArray *providers = g_hash_table_lookup (index->providers, key);
+    AiiProvider *provider = g_new0 (AiiProvider, 1);
+
+    if (providers == NULL) {
+        providers = g_ptr_array_new_with_free_func ((GDestroyNotify) aii_provider_free);
+        g_hash_table_insert (index->providers, key, providers);
+    } else {
+        g_free (key);
+    }
+
+    provider->factory = gst_object_ref (factory);
+    provider->rank = gst_plugin_feature_get_rank (GST_PLUGIN_FEATURE (factory));
+    provider->caps = caps;
+    g_ptr_array_add (providers, provider);
+}
+
+/* NOTE: Not coloring output from automatic install functions, as their output
+ * is meant for machines, not humans.
+ */
+static void
+aii_index_add_codecs (AiiIndex * index, AiiFactory * entry, GString * lines,
+                      GstElementFactory * factory)
+{
+    GstPadDirection direction;
+    const gchar *type_name;
+    const gchar *klass;
+    const GList *static_templates, *l;
+    GstCaps *caps = NULL;
+    guint i, num;
+
+    klass =
+            gst_element_factory_get_metadata (factory, GST_ELEMENT_METADATA_KLASS);
+    g_return_if_fail (klass != NULL);
+
+    if (strstr (klass, "Demuxer") ||
+        strstr (klass, "Decoder") ||
+        strstr (klass, "Depay") || strstr (klass, "Parser")) {
+        type_name = "decoder";
+        direction = GST_PAD_SINK;
+    } else if (strstr (klass, "Muxer") ||
+               strstr (klass, "Encoder") || strstr (klass, "Pay")) {
+        type_name = "encoder";
+        direction = GST_PAD_SRC;
+    } else {
+        return;
+    }
+
+    /* decoder/demuxer sink pads should always be static and there should only
+     * be one, the same applies to encoders/muxers and source pads */
+    static_templates = gst_element_factory_get_static_pad_templates (factory);
+    for (l = static_templates; l != NULL; l = l->next) {
+        GstStaticPadTemplate *tmpl = NULL;
+
+        tmpl = (GstStaticPadTemplate *) l->data;
+        if (tmpl->direction == direction) {
+            caps = gst_static_pad_template_get_caps (tmpl);
+            break;
+        }
+    }
+
+    if (caps == NULL) {
+        entry->error = g_strdup_printf ("Couldn't find static pad template for "
+                                        "%s '%s'\n", type_name, GST_OBJECT_NAME (factory));
+        return;
+    }
+
+    caps = gst_caps_make_writable (caps);
+    num = gst_caps_get_size (caps);
+    for (i = 0; i < num; ++i) {
+        GstStructure *s;
+        gchar *s_str;
+
+        s = gst_caps_get_structure (caps, i);
+        /* remove fields that are almost always just MIN-MAX of some sort
+         * in order to make the caps look less messy */
+        gst_structure_remove_field (s, "pixel-aspect-ratio");
+        gst_structure_remove_field (s, "framerate");
+        gst_structure_remove_field (s, "channels");
+        gst_structure_remove_field (s, "width");
+        gst_structure_remove_field (s, "height");
+        gst_structure_remove_field (s, "rate");
+        gst_structure_remove_field (s, "depth");
+        gst_structure_remove_field (s, "clock-rate");
+        s_str = gst_structure_to_string (s);
+        g_string_append_printf (lines, "%s-%s\n", type_name, s_str);
+        g_free (s_str);
+
+        aii_index_add (index, type_name, gst_structure_get_name (s), factory,
+                       gst_caps_new_full (gst_structure_copy (s), NULL));
+    }
+    gst_caps_unref (caps);
+}
+
+static void
+aii_index_add_protocols (AiiIndex * index, GString * lines,
+                         GstElementFactory * factory)
+{
+    const gchar *const *protocols;
+    const gchar *type_name;
+
+    switch (gst_element_factory_get_uri_type (factory)) {
+        case GST_URI_SINK:
+            type_name = "urisink";
+            break;
+        case GST_URI_SRC:
+            type_name = "urisource";
+            break;
+        default:
+            return;
+    }
+
+    protocols = gst_element_factory_get_uri_protocols (factory);
+    for (; protocols != NULL && *protocols != NULL; ++protocols) {
+        g_string_append_printf (lines, "%s-%s\n", type_name, *protocols);
+        aii_index_add (index, type_name, *protocols, factory, NULL);
+    }
+}
+
+static AiiIndex *
+aii_index_build (void)
+{
+    GstRegistry *registry = gst_registry_get ();
+    AiiIndex *index = g_new0 (AiiIndex, 1);
+    GString *lines = g_string_new (NULL);
+    GHashTableIter iter;
+    gpointer providers;
+    GList *features, *f;
+
+    index->cookie = gst_registry_get_feature_list_cookie (registry);
+    index->factories = g_hash_table_new_full (g_str_hash, g_str_equal, g_free,
+                                              (GDestroyNotify) aii_factory_free);
+    index->providers = g_hash_table_new_full (g_str_hash, g_str_equal, g_free,
+                                              (GDestroyNotify) g_ptr_array_unref);
+
+    /* not interested in typefind factories, only element factories */
+    features = gst_registry_get_feature_list (registry, GST_TYPE_ELEMENT_FACTORY);
+    for (f = features; f != NULL; f = f->next) {
+        GstElementFactory *factory = GST_ELEMENT_FACTORY (f->data);
+        AiiFactory *entry = g_new0 (AiiFactory, 1);
+
+        g_string_printf (lines, "element-%s\n", GST_OBJECT_NAME (factory));
+        aii_index_add (index, "element", GST_OBJECT_NAME (factory), factory, NULL);
+        aii_index_add_protocols (index, lines, factory);
+        aii_index_add_codecs (index, entry, lines, factory);
+
+        entry->lines = g_strdup (lines->str);
+        g_hash_table_insert (index->factories, g_strdup (GST_OBJECT_NAME (factory)),
+                             entry);
+    }
+    gst_plugin_feature_list_free (features);
+    g_string_free (lines, TRUE);
+
+    g_hash_table_iter_init (&iter, index->providers);
+    while (g_hash_table_iter_next (&iter, NULL, &providers))
+        g_ptr_array_sort (providers, aii_provider_compare);
+
+    GST_INFO ("Install info index: %u factories, %u details",
+              g_hash_table_size (index->factories),
+              g_hash_table_size (index->providers));
+    return index;
+}
+
+/* Make sure aii_index matches the registry. Call with aii_lock held. */
+static void
+aii_index_update (void)
+{
+    guint32 cookie = gst_registry_get_feature_list_cookie (gst_registry_get ());
+
+    if (aii_index != NULL && aii_index->cookie == cookie)
+        return;
+    if (aii_index != NULL)
+        aii_index_free (aii_index);
+    aii_index = aii_index_build ();
+}
+
+/* The factories providing the install detail @detail, best ranked first,
+ * as a new array of new references. For "decoder-" and "encoder-" details
+ * the caps name picks the candidates and any fields must intersect with
+ * theirs, e.g. "decoder-audio/mpeg, mpegversion=(int)4". Returns NULL if
+ * @detail can't be parsed. */
+static GPtrArray *
+aii_index_lookup (const gchar * detail)
+{
+    const gchar *dash = strchr (detail, '-');
+    GPtrArray *found, *providers;
+    GstCaps *caps = NULL;
+    gchar *key;
+    guint i;
+
+    if (dash == NULL || dash[1] == '\0')
+        return NULL;
+
+    if (g_str_has_prefix (detail, "decoder-") ||
+        g_str_has_prefix (detail, "encoder-")) {
+        caps = gst_caps_from_string (dash + 1);
+        if (caps == NULL || gst_caps_get_size (caps) != 1) {
+            if (caps)
+                gst_caps_unref (caps);
+            return NULL;
+        }
+        key = g_strdup_printf ("%.*s-%s", (gint) (dash - detail), detail,
+                               gst_structure_get_name (gst_caps_get_structure (caps, 0)));
+    } else {
+        key = g_strdup (detail);
+    }
+
+    found = g_ptr_array_new_with_free_func (gst_object_unref);
+
+    g_mutex_lock (&aii_lock);
+    aii_index_update ();
+    providers = g_hash_table_lookup (aii_index->providers, key);
+    for (i = 0; providers != NULL && i < providers->len; i++) {
+        AiiProvider *provider = g_ptr_array_index (providers, i);
+
+        if (caps != NULL && !gst_caps_can_intersect (caps, provider->caps))
+            continue;
+        /* a factory may list the same caps name more than once */
+        if (found->len > 0 &&
+            g_ptr_array_index (found, found->len - 1) == provider->factory)
+            continue;
+        g_ptr_array_add (found, gst_object_ref (provider->factory));
+    }
+    g_mutex_unlock (&aii_lock);
+
+    if (caps)
+        gst_caps_unref (caps);
+    g_free (key);
+    return found;
+}
+
+/* --provides: the elements providing an install detail */
+static int
+print_aii_providers (const gchar * detail)
+{
+    GPtrArray *found = aii_index_lookup (detail);
+    guint i;
+
+    if (found == NULL) {
+        g_printerr ("Can't parse '%s', expected something like element-NAME, "
+                    "decoder-CAPS, encoder-CAPS, urisource-PROTOCOL or "
+                    "urisink-PROTOCOL\n", detail);
+        return -1;
+    }
+
+    if (found->len == 0)
+        g_print ("No element provides '%s'\n", detail);
+    for (i = 0; i < found->len; i++)
+        g_print ("%s\n", GST_OBJECT_NAME (g_ptr_array_index (found, i)));
+
+    i = found->len;
+    g_ptr_array_unref (found);
+    return i > 0 ? 0 : 1;
+}
+
+static void
+print_plugin_automatic_install_info (GstPlugin * plugin)
+{
+    RegistryListing *listing = registry_listing_get ();
+    GstPluginFeature **features;
+    guint n_features, i;
+
+    features = registry_listing_features (listing, plugin, &n_features);
+
+    g_mutex_lock (&aii_lock);
+    aii_index_update ();
+    for (i = 0; i < n_features; i++) {
+        AiiFactory *entry;
+
+        if (!GST_IS_ELEMENT_FACTORY (features[i]))
+            continue;
+
+        entry = g_hash_table_lookup (aii_index->factories,
+                                     GST_OBJECT_NAME (features[i]));
+        if (entry == NULL)
+            continue;
+        g_print ("%s", entry->lines);
+        if (entry->error)
+            g_printerr ("%s", entry->error);
+    }
+    g_mutex_unlock (&aii_lock);
+
+    registry_listing_unref (listing);
+}
+
+static void
+print_all_plugin_automatic_install_info (void)
+{
+    RegistryListing *listing = registry_listing_get ();
+    guint i;
+
+    for (i = 0; i < listing->n_plugins && !inspect_cancelled (); i++)
+        print_plugin_automatic_install_info (listing->plugins[i].plugin);
+    registry_listing_unref (listing);
+}
+
+/* Search index: trigrams of every feature's name, long name, klass and
+ * description, so that as-you-type lookups don't walk the registry. It is
+ * built once and only rebuilt when the registry's feature list changes. */
+typedef struct
+{
+    gchar *name;                /* Feature name, as returned */
+    gchar *text;                /* Lowercase "name\nlongname\nklass\ndescription" */
+} SearchEntry;
+
+typedef struct
+{
+    guint32 cookie;             /* Feature list cookie the index was built for */
+    GArray *entries;            /* SearchEntry, sorted by name */
+    GHashTable *trigrams;       /* Packed trigram -> GArray of entry indices */
+} SearchIndex;
+
+static GMutex search_lock;
+static SearchIndex *search_index = NULL;
+
+#define TRIGRAM(p) (((guint32) (guint8) (p)[0] << 16) | \
+                    ((guint32) (guint8) (p)[1] << 8) | (guint32) (guint8) (p)[2])
+
+static gboolean
+is_trigram (const gchar * p)
+{
+    return p[0] != '\n' && p[1] != '\n' && p[2] != '\n';
+}
+
+static gint
+search_entry_compare (gconstpointer a, gconstpointer b)
+{
+    return strcmp (((const SearchEntry *) a)->name,
+                   ((const SearchEntry *) b)->name);
+}
+
+static void
+search_index_free (SearchIndex * index)
+{
+    guint i;
+
+    for (i = 0; i < index->entries->len; i++) {
+        SearchEntry *entry = &g_array_index (index->entries, SearchEntry, i);
+
+        g_free (entry->name);
+        g_free (entry->text);
+    }
+    g_array_unref (index->entries);
+    g_hash_table_unref (index->trigrams);
+    g_free (index);
+}
+
+static SearchIndex *
+search_index_build (void)
+{
+    GstRegistry *registry = gst_registry_get ();
+    SearchIndex *index = g_new0 (SearchIndex, 1);
+    GList *features, *l;
+    guint i;
+
+    index->cookie = gst_registry_get_feature_list_cookie (registry);
+    index->entries = g_array_new (FALSE, FALSE, sizeof (SearchEntry));
+    index->trigrams = g_hash_table_new_full (NULL, NULL, NULL,
+                                             (GDestroyNotify) g_array_unref);
+
+    features = gst_registry_get_feature_list (registry, GST_TYPE_PLUGIN_FEATURE);
+    for (l = features; l != NULL; l = l->next) {
+        GstPluginFeature *feature = GST_PLUGIN_FEATURE (l->data);
+        const gchar *longname = NULL, *klass = NULL, *description = NULL;
+        SearchEntry entry;
+        gchar *text;
+
+        if (GST_IS_ELEMENT_FACTORY (feature)) {
+            GstElementFactory *factory = GST_ELEMENT_FACTORY (feature);
+
+            longname = gst_element_factory_get_metadata (factory,
+                                                         GST_ELEMENT_METADATA_LONGNAME);
+            klass = gst_element_factory_get_metadata (factory,
+                                                      GST_ELEMENT_METADATA_KLASS);
+            description = gst_element_factory_get_metadata (factory,
+                                                            GST_ELEMENT_METADATA_DESCRIPTION);
+        } else if (GST_IS_DEVICE_PROVIDER_FACTORY (feature)) {
+            GstDeviceProviderFactory *factory = GST_DEVICE_PROVIDER_FACTORY (feature);
+
+            longname = gst_device_provider_factory_get_metadata (factory,
+                                                                 GST_ELEMENT_METADATA_LONGNAME);
+            klass = gst_device_provider_factory_get_metadata (factory,
+                                                              GST_ELEMENT_METADATA_KLASS);
+            description = gst_device_provider_factory_get_metadata (factory,
+                                                                    GST_ELEMENT_METADATA_DESCRIPTION);
+        }
+
+        text = g_strjoin ("\n", GST_OBJECT_NAME (feature),
+                          GST_STR_NULL (longname), GST_STR_NULL (klass),
+                          GST_STR_NULL (description), NULL);
+        entry.name = g_strdup (GST_OBJECT_NAME (feature));
+        entry.text = g_ascii_strdown (text, -1);
+        g_free (text);
+        g_array_append_val (index->entries, entry);
+    }
+    gst_plugin_feature_list_free (features);
+
+    g_array_sort (index->entries, search_entry_compare);
+
+    for (i = 0; i < index->entries->len; i++) {
+        const gchar *p = g_array_index (index->entries, SearchEntry, i).text;
+
+        for (; p[0] && p[1] && p[2]; p++) {
+            GArray *postings;
+            guint32 trigram;
+
+            if (!is_trigram (p))
+                continue;
+            trigram = TRIGRAM (p);
+            postings = g_hash_table_lookup (index->trigrams,
+                                            GUINT_TO_POINTER (trigram));
+            if (postings == NULL) {
+                postings = g_array_new (FALSE, FALSE, sizeof (guint));
+                g_hash_table_insert (index->trigrams, GUINT_TO_POINTER (trigram),
+                                     postings);
+            }
+            /* entries are visited in order, so a repeat can only be the last */
+            if (postings->len == 0
+                || g_array_index (postings, guint, postings->len - 1) != i)
+                g_array_append_val (postings, i);
+        }
+    }
+
+    GST_INFO ("Search index: %u features, %u trigrams", index->entries->len,
+              g_hash_table_size (index->trigrams));
+    return index;
+}
+
+/* Make sure search_index matches the registry. Call with search_lock held. */
+static void
+search_index_update (void)
+{
+    guint32 cookie = gst_registry_get_feature_list_cookie (gst_registry_get ());
+
+    if (search_index != NULL && search_index->cookie == cookie)
+        return;
+    if (search_index != NULL)
+        search_index_free (search_index);
+    search_index = search_index_build ();
+}
+
+typedef struct
+{
+    guint entry;
+    guint score;
+} SearchMatch;
+
+static gint
+search_match_compare (gconstpointer a, gconstpointer b)
+{
+    const SearchMatch *ma = a, *mb = b;
+
+    if (ma->score != mb->score)
+        return ma->score > mb->score ? -1 : 1;
+    /* entries are sorted by name, keep that order among equals */
+    return ma->entry < mb->entry ? -1 : (ma->entry > mb->entry);
+}
+
+/* Rank how well @entry matches the lowercase @query; @hits is the number
+ * of the query's @n_trigrams found in the entry */
+static guint
+search_score (const SearchEntry * entry, const gchar * query, guint hits,
+              guint n_trigrams)
+{
+    const gchar *name_end = strchr (entry->text, '\n');
+    gsize name_len = name_end - entry->text;
+    gsize query_len = strlen (query);
+    const gchar *found;
+
+    if (name_len == query_len && !strncmp (entry->text, query, query_len))
+        return 1000;
+    if (name_len > query_len && !strncmp (entry->text, query, query_len))
+        return 800;
+    found = strstr (entry->text, query);
+    if (found != NULL && found < name_end)
+        return 600;
+    if (found != NULL)
+        return 400;
+    return n_trigrams ? 300 * hits / n_trigrams : 0;
+}
+
+/* Up to @limit feature names matching @query, best first. Queries of three
+ * or more characters tolerate typos: an entry is a candidate when it shares
+ * at least half of the query's trigrams. */
+static GPtrArray *
+search_index_query (const gchar * query, guint limit)
+{
+    GPtrArray *result = g_ptr_array_new_with_free_func (g_free);
+    GArray *matches;
+    gchar *q;
+    guint i;
+
+    q = g_ascii_strdown (query, -1);
+    g_strstrip (q);
+    if (*q == '\0' || limit == 0) {
+        g_free (q);
+        return result;
+    }
+
+    matches = g_array_new (FALSE, FALSE, sizeof (SearchMatch));
+
+    g_mutex_lock (&search_lock);
+    search_index_update ();
+
+    if (strlen (q) < 3) {
+        /* too short for trigrams, the names alone are few enough to scan */
+        for (i = 0; i < search_index->entries->len; i++) {
+            SearchEntry *entry = &g_array_index (search_index->entries, SearchEntry, i);
+            guint score = search_score (entry, q, 0, 0);
+
+            if (score >= 600) {
+                SearchMatch match = { i, score };
+                g_array_append_val (matches, match);
+            }
+        }
+    } else {
+        guint16 *hits = g_new0 (guint16, search_index->entries->len);
+        GHashTable *seen = g_hash_table_new (NULL, NULL);
+        guint n_trigrams = 0;
+        const gchar *p;
+
+        for (p = q; p[0] && p[1] && p[2]; p++) {
+            guint32 trigram = TRIGRAM (p);
+            GArray *postings;
+            guint j;
+
+            /* count each distinct trigram of the query once */
+            if (!g_hash_table_add (seen, GUINT_TO_POINTER (trigram)))
+                continue;
+            n_trigrams++;
+
+            postings = g_hash_table_lookup (search_index->trigrams,
+                                            GUINT_TO_POINTER (trigram));
+            if (postings == NULL)
+                continue;
+            for (j = 0; j < postings->len; j++)
+                hits[g_array_index (postings, guint, j)]++;
+        }
+
+        for (i = 0; i < search_index->entries->len; i++) {
+            SearchMatch match;
+
+            if (hits[i] == 0 || 2 * hits[i] < n_trigrams)
+                continue;
+            match.entry = i;
+            match.score = search_score (&g_array_index (search_index->entries,
+                                                        SearchEntry, i), q, hits[i], n_trigrams);
+            g_array_append_val (matches, match);
+        }
+
+        g_hash_table_unref (seen);
+        g_free (hits);
+    }
+
+    g_array_sort (matches, search_match_compare);
+    for (i = 0; i < matches->len && i < limit; i++) {
+        SearchMatch *match = &g_array_index (matches, SearchMatch, i);
+
+        g_ptr_array_add (result, g_strdup (g_array_index (search_index->entries,
+                                                          SearchEntry, match->entry).name));
+    }
+    g_mutex_unlock (&search_lock);
+
+    g_array_unref (matches);
+    g_free (q);
+    return result;
+}
+
+/* Caps index: every element factory's static pad templates, keyed by the
+ * structure names they can handle. A caps query only has to intersect
+ * against the templates filed under its own media types. */
+typedef struct
+{
+    GstElementFactory *factory;
+    GstPadDirection direction;
+    GstCaps *caps;
+} CapsTemplate;
+
+typedef struct
+{
+    guint32 cookie;             /* Feature list cookie the index was built for */
+    GPtrArray *templates;       /* All CapsTemplate, owns them */
+    GHashTable *by_name;        /* Structure name -> GPtrArray of CapsTemplate */
+    GPtrArray *any;             /* CapsTemplate with ANY caps */
+    GHashTable *src_by_factory; /* Factory -> GPtrArray of its non-ANY src CapsTemplate */
+} CapsIndex;
+
+static GMutex caps_lock;
+static CapsIndex *caps_index = NULL;
+
+static void
+caps_template_free (CapsTemplate * templ)
+{
+    gst_object_unref (templ->factory);
+    gst_caps_unref (templ->caps);
+    g_free (templ);
+}
+
+static void
+caps_index_free (CapsIndex * index)
+{
+    g_hash_table_unref (index->by_name);
+    g_hash_table_unref (index->src_by_factory);
+    g_ptr_array_unref (index->any);
+    g_ptr_array_unref (index->templates);
+    g_free (index);
+}
+
+/* Highest rank first, then by name */
+static gint
+caps_template_compare (gconstpointer a, gconstpointer b)
+{
+    const CapsTemplate *ta = *(const CapsTemplate **) a;
+    const CapsTemplate *tb = *(const CapsTemplate **) b;
+    guint ra = gst_plugin_feature_get_rank (GST_PLUGIN_FEATURE (ta->factory));
+    guint rb = gst_plugin_feature_get_rank (GST_PLUGIN_FEATURE (tb->factory));
+
+    if (ra != rb)
+        return ra > rb ? -1 : 1;
+    return strcmp (GST_OBJECT_NAME (ta->factory), GST_OBJECT_NAME (tb->factory));
+}
+
+static CapsIndex *
+caps_index_build (void)
+{
+    GstRegistry *registry = gst_registry_get ();
+    CapsIndex *index = g_new0 (CapsIndex, 1);
+    GHashTableIter iter;
+    gpointer list;
+    GList *features, *l;
+
+    index->cookie = gst_registry_get_feature_list_cookie (registry);
+    index->templates =
+            g_ptr_array_new_with_free_func ((GDestroyNotify) caps_template_free);
+    index->by_name = g_hash_table_new_full (g_str_hash, g_str_equal, g_free,
+                                            (GDestroyNotify) g_ptr_array_unref);
+    index->any = g_ptr_array_new ();
+    index->src_by_factory = g_hash_table_new_full (NULL, NULL, NULL,
+                                                   (GDestroyNotify) g_ptr_array_unref);
+
+    features = gst_registry_get_feature_list (registry, GST_TYPE_ELEMENT_FACTORY);
+    for (l = features; l != NULL; l = l->next) {
+        GstElementFactory *factory = GST_ELEMENT_FACTORY (l->data);
+        const GList *pads;
+
+        for (pads = gst_element_factory_get_static_pad_templates (factory);
+             pads != NULL; pads = pads->next) {
+            GstStaticPadTemplate *padtemplate = pads->data;
+            CapsTemplate *templ;
+            guint i, n;
+
+            templ = g_new0 (CapsTemplate, 1);
+            templ->factory = gst_object_ref (factory);
+            templ->direction = padtemplate->direction;
+            templ->caps = gst_static_pad_template_get_caps (padtemplate);
+            g_ptr_array_add (index->templates, templ);
+
+            if (gst_caps_is_any (templ->caps)) {
+                g_ptr_array_add (index->any, templ);
+                continue;
+            }
+
+            if (templ->direction == GST_PAD_SRC) {
+                GPtrArray *srcs = g_hash_table_lookup (index->src_by_factory, factory);
+
+                if (srcs == NULL) {
+                    srcs = g_ptr_array_new ();
+                    g_hash_table_insert (index->src_by_factory, factory, srcs);
+                }
+                g_ptr_array_add (srcs, templ);
+            }
+
+            n = gst_caps_get_size (templ->caps);
+            for (i = 0; i < n; i++) {
+                const gchar *name =
+                        gst_structure_get_name (gst_caps_get_structure (templ->caps, i));
+                GPtrArray *templates = g_hash_table_lookup (index->by_name, name);
+
+                if (templates == NULL) {
+                    templates = g_ptr_array_new ();
+                    g_hash_table_insert (index->by_name, g_strdup (name), templates);
+                }
+                /* a template lists a media type once per structure */
+                if (templates->len == 0
+                    || g_ptr_array_index (templates, templates->len - 1) != templ)
+                    g_ptr_array_add (templates, templ);
+            }
+        }
+    }
+    gst_plugin_feature_list_free (features);
+
+    g_hash_table_iter_init (&iter, index->by_name);
+    while (g_hash_table_iter_next (&iter, NULL, &list))
+        g_ptr_array_sort (list, caps_template_compare);
+    g_ptr_array_sort (index->any, caps_template_compare);
+
+    GST_INFO ("Caps index: %u pad templates, %u media types",
+              index->templates->len, g_hash_table_size (index->by_name));
+    return index;
+}
+
+/* Make sure caps_index matches the registry. Call with caps_lock held. */
+static void
+caps_index_update (void)
+{
+    guint32 cookie = gst_registry_get_feature_list_cookie (gst_registry_get ());
+
+    if (caps_index != NULL && caps_index->cookie == cookie)
+        return;
+    if (caps_index != NULL)
+        caps_index_free (caps_index);
+    caps_index = caps_index_build ();
+}
+
+/* Templates of @direction whose caps intersect @caps, best ranked first.
+ * Call with caps_lock held; the templates belong to caps_index. */
+static GPtrArray *
+caps_index_lookup (const GstCaps * caps, GstPadDirection direction)
+{
+    GPtrArray *result = g_ptr_array_new ();
+    GHashTable *seen = g_hash_table_new (NULL, NULL);
+    guint i, j, n = gst_caps_get_size (caps);
+
+    for (i = 0; i < n; i++) {
+        const gchar *name = gst_structure_get_name (gst_caps_get_structure (caps, i));
+        GPtrArray *templates = g_hash_table_lookup (caps_index->by_name, name);
+
+        if (templates == NULL)
+            continue;
+        for (j = 0; j < templates->len; j++) {
+            CapsTemplate *templ = g_ptr_array_index (templates, j);
+
+            if (templ->direction != direction
+                || !g_hash_table_add (seen, templ))
+                continue;
+            if (gst_caps_can_intersect (caps, templ->caps))
+                g_ptr_array_add (result, templ);
+        }
+    }
+    g_hash_table_unref (seen);
+
+    if (n > 1)
+        g_ptr_array_sort (result, caps_template_compare);
+    return result;
+}
+
+static void
+print_caps_matches (const GstCaps * caps, GstPadDirection direction)
+{
+    GPtrArray *matches = caps_index_lookup (caps, direction);
+    GHashTable *printed = g_hash_table_new (NULL, NULL);
+    guint i, n_any = 0;
+
+    g_print ("%s%s%s:\n", HEADING_COLOR,
+             direction == GST_PAD_SINK ? "Accepted by" : "Produced by", RESET_COLOR);
+    push_indent ();
+    for (i = 0; i < matches->len; i++) {
+        CapsTemplate *templ = g_ptr_array_index (matches, i);
+
+        /* one line per element, even with several matching templates */
+        if (!g_hash_table_add (printed, templ->factory))
+            continue;
+        n_print ("%s%s%s (%srank %u%s): %s\n", FEATURE_NAME_COLOR,
+                 GST_OBJECT_NAME (templ->factory), RESET_COLOR, FEATURE_RANK_COLOR,
+                 gst_plugin_feature_get_rank (GST_PLUGIN_FEATURE (templ->factory)),
+                 RESET_COLOR, gst_element_factory_get_metadata (templ->factory,
+                                                               GST_ELEMENT_METADATA_LONGNAME));
+    }
+    if (g_hash_table_size (printed) == 0)
+        n_print ("none\n");
+    for (i = 0; i < caps_index->any->len; i++)
+        if (((CapsTemplate *) g_ptr_array_index (caps_index->any, i))->direction ==
+            direction)
+            n_any++;
+    if (n_any > 0)
+        n_print ("(and %u pad templates with ANY caps)\n", n_any);
+    pop_indent ();
+    g_print ("\n");
+
+    g_hash_table_unref (printed);
+    g_ptr_array_unref (matches);
+}
+
+/* --caps: list the elements that can accept or produce @caps_str */
+static int
+print_caps_query (const gchar * caps_str)
+{
+    GstCaps *caps = gst_caps_from_string (caps_str);
+
+    if (caps == NULL) {
+        g_printerr ("Could not parse caps '%s'\n", caps_str);
+        return -1;
+    }
+    if (gst_caps_is_any (caps) || gst_caps_is_empty (caps)) {
+        g_printerr ("--caps needs at least one media type\n");
+        gst_caps_unref (caps);
+        return -1;
+    }
+
+    g_mutex_lock (&caps_lock);
+    caps_index_update ();
+    print_caps_matches (caps, GST_PAD_SINK);
+    print_caps_matches (caps, GST_PAD_SRC);
+    g_mutex_unlock (&caps_lock);
+
+    gst_caps_unref (caps);
+    return 0;
+}
+
+/* Path finder: uniform-cost search over the caps index for the cheapest
+ * chains of elements turning one caps into another. Each element costs
+ * more the lower its rank, and converters cost extra, so the search
+ * prefers short chains of well-ranked elements. A state is an element's
+ * src template; it is only pushed again when reached cheaper or in fewer
+ * elements than before, which keeps the many raw-caps filters from
+ * multiplying the queue at every level. The number of search nodes is
+ * still bounded, so memory and time are too. */
+#define PATH_MAX_ELEMENTS 4
+#define PATH_MAX_NODES 20000
+#define PATH_MAX_RESULTS 5
+
+typedef struct _PathNode PathNode;
+struct _PathNode
+{
+    PathNode *parent;           /* NULL for the source caps */
+    GstElementFactory *factory; /* Element taking parent's caps, or NULL */
+    GstCaps *caps;              /* Caps out of this node, owned by caps_index */
+    guint cost;
+    guint depth;
+    guint seq;                  /* Creation order, breaks cost ties */
+};
+
+static gint
+path_node_compare (gconstpointer a, gconstpointer b, gpointer user_data)
+{
+    const PathNode *na = a, *nb = b;
+
+    if (na->cost != nb->cost)
+        return na->cost < nb->cost ? -1 : 1;
+    return na->seq < nb->seq ? -1 : (na->seq > nb->seq);
+}
+
+static guint
+path_element_cost (GstElementFactory * factory)
+{
+    guint rank = gst_plugin_feature_get_rank (GST_PLUGIN_FEATURE (factory));
+    const gchar *klass =
+            gst_element_factory_get_metadata (factory, GST_ELEMENT_METADATA_KLASS);
+    guint cost;
+
+    /* primary 1, secondary 3, marginal 4, none 5 */
+    cost = 1 + (GST_RANK_PRIMARY - MIN (rank, GST_RANK_PRIMARY)) / 64;
+    if (klass != NULL && strstr (klass, "Converter") != NULL)
+        cost += 2;
+    return cost;
+}
+
+static gboolean
+path_uses_factory (const PathNode * node, GstElementFactory * factory)
+{
+    for (; node != NULL; node = node->parent)
+        if (node->factory == factory)
+            return TRUE;
+    return FALSE;
+}
+
+static gchar *
+path_to_string (const PathNode * node)
+{
+    GPtrArray *names = g_ptr_array_new ();
+    GString *str = g_string_new (NULL);
+    gint i;
+
+    for (; node->parent != NULL; node = node->parent)
+        g_ptr_array_add (names, GST_OBJECT_NAME (node->factory));
+    for (i = names->len - 1; i >= 0; i--) {
+        g_string_append (str, g_ptr_array_index (names, i));
+        if (i > 0)
+            g_string_append (str, " ! ");
+    }
+    g_ptr_array_unref (names);
+    return g_string_free (str, FALSE);
+}
+
+/* --from/--to: print the cheapest chains of elements between two caps */
+static int
+print_caps_paths (const gchar * from_str, const gchar * to_str)
+{
+    GstCaps *from = gst_caps_from_string (from_str);
+    GstCaps *to = gst_caps_from_string (to_str);
+    GPtrArray *nodes;
+    GSequence *queue;
+    GHashTable *found;
+    GHashTable *best;           /* src CapsTemplate -> cheapest PathNode */
+    PathNode *start;
+    gint64 start_time;
+    guint n_results = 0;
+    gboolean exhausted = FALSE;
+
+    if (from == NULL || to == NULL) {
+        g_printerr ("Could not parse caps '%s'\n", from == NULL ? from_str : to_str);
+        if (from)
+            gst_caps_unref (from);
+        if (to)
+            gst_caps_unref (to);
+        return -1;
+    }
+    if (gst_caps_is_any (from) || gst_caps_is_empty (from)) {
+        g_printerr ("--from needs at least one media type\n");
+        gst_caps_unref (from);
+        gst_caps_unref (to);
+        return -1;
+    }
+
+    start_time = g_get_monotonic_time ();
+    nodes = g_ptr_array_new_with_free_func (g_free);
+    queue = g_sequence_new (NULL);
+    found = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+    best = g_hash_table_new (NULL, NULL);
+
+    g_mutex_lock (&caps_lock);
+    caps_index_update ();
+
+    start = g_new0 (PathNode, 1);
+    start->caps = from;
+    g_ptr_array_add (nodes, start);
+    g_sequence_insert_sorted (queue, start, path_node_compare, NULL);
+
+    g_print ("%sElement chains from%s %s %sto%s %s:\n", HEADING_COLOR,
+             RESET_COLOR, from_str, HEADING_COLOR, RESET_COLOR, to_str);
+    push_indent ();
+
+    while (!g_sequence_is_empty (queue) && n_results < PATH_MAX_RESULTS
+           && !inspect_cancelled ()) {
+        GSequenceIter *first = g_sequence_get_begin_iter (queue);
+        PathNode *node = g_sequence_get (first);
+        GPtrArray *sinks;
+        guint i, j;
+
+        g_sequence_remove (first);
+
+        if (node->depth > 0 && gst_caps_can_intersect (node->caps, to)) {
+            gchar *chain = path_to_string (node);
+
+            /* several src templates of one element lead to the same chain */
+            if (g_hash_table_add (found, chain)) {
+                n_print ("%scost %u%s: %s\n", FEATURE_RANK_COLOR, node->cost,
+                         RESET_COLOR, chain);
+                n_results++;
+            }
+            continue;
+        }
+        if (node->depth == PATH_MAX_ELEMENTS)
+            continue;
+        if (nodes->len >= PATH_MAX_NODES) {
+            exhausted = TRUE;
+            continue;
+        }
+
+        sinks = caps_index_lookup (node->caps, GST_PAD_SINK);
+        for (i = 0; i < sinks->len && nodes->len < PATH_MAX_NODES; i++) {
+            CapsTemplate *sink = g_ptr_array_index (sinks, i);
+            GPtrArray *srcs =
+                    g_hash_table_lookup (caps_index->src_by_factory, sink->factory);
+            guint cost;
+
+            if (srcs == NULL || path_uses_factory (node, sink->factory))
+                continue;
+
+            cost = node->cost + path_element_cost (sink->factory);
+            for (j = 0; j < srcs->len; j++) {
+                CapsTemplate *src = g_ptr_array_index (srcs, j);
+                PathNode *seen = g_hash_table_lookup (best, src);
+                PathNode *next;
+
+                if (seen != NULL && seen->cost <= cost
+                    && seen->depth <= node->depth + 1)
+                    continue;
+                if (nodes->len >= PATH_MAX_NODES) {
+                    exhausted = TRUE;
+                    break;
+                }
+
+                next = g_new0 (PathNode, 1);
+                next->parent = node;
+                next->factory = sink->factory;
+                next->caps = src->caps;
+                next->cost = cost;
+                next->depth = node->depth + 1;
+                next->seq = nodes->len;
+                g_ptr_array_add (nodes, next);
+                g_hash_table_insert (best, src, next);
+                g_sequence_insert_sorted (queue, next, path_node_compare, NULL);
+            }
+        }
+        if (i < sinks->len)
+            exhausted = TRUE;
+        g_ptr_array_unref (sinks);
+    }
+
+    if (exhausted && n_results < PATH_MAX_RESULTS)
+        n_print ("search stopped after %d nodes, longer chains were not "
+                 "all tried\n", PATH_MAX_NODES);
+    else if (n_results == 0)
+        n_print ("none found within %d elements\n", PATH_MAX_ELEMENTS);
+    pop_indent ();
+    g_mutex_unlock (&caps_lock);
+
+    GST_INFO ("Path search visited %u nodes in %" G_GINT64_FORMAT " us",
+              nodes->len, g_get_monotonic_time () - start_time);
+
+    g_hash_table_unref (best);
+    g_hash_table_unref (found);
+    g_sequence_free (queue);
+    g_ptr_array_unref (nodes);
+    gst_caps_unref (from);
+    gst_caps_unref (to);
+    return 0;
+}
+
+/* Profiler: what each element factory costs to instantiate, to find the
+ * plugins worth dropping from GSTREAMER_PLUGINS */
+#define PROFILE_TOP_N 15
+
+typedef struct
+{
+    GstElementFactory *factory;
+    const gchar *plugin;
+    gint64 create_us;           /* gst_element_factory_create() */
+    gint64 ready_us;            /* NULL to READY */
+    gint64 rss_delta;           /* Resident memory grown by, in bytes */
+    gboolean ready_failed;
+} FactoryProfile;
+
+/* Resident set size of this process in bytes, 0 if unknown */
+static gint64
+get_resident_size (void)
+{
+#ifdef G_OS_UNIX
+    gchar *contents = NULL;
+    unsigned long resident = 0;
+
+    if (g_file_get_contents ("/proc/self/statm", &contents, NULL, NULL))
+        sscanf (contents, "%*lu %lu", &resident);
+    g_free (contents);
+    return (gint64) resident * sysconf (_SC_PAGESIZE);
+#else
+    return 0;
+#endif
+}
+
+static gint
+factory_profile_compare_time (gconstpointer a, gconstpointer b)
+{
+    const FactoryProfile *pa = a, *pb = b;
+    gint64 ta = pa->create_us + pa->ready_us, tb = pb->create_us + pb->ready_us;
+
+    return ta > tb ? -1 : (ta < tb);
+}
+
+static gint
+factory_profile_compare_memory (gconstpointer a, gconstpointer b)
+{
+    const FactoryProfile *pa = a, *pb = b;
+
+    return pa->rss_delta > pb->rss_delta ? -1 : (pa->rss_delta < pb->rss_delta);
+}
+
+static void
+factory_profile_run (FactoryProfile * profile)
+{
+    GstElement *element;
+    gint64 rss, start;
+
+    rss = get_resident_size ();
+    start = g_get_monotonic_time ();
+    element = gst_element_factory_create (profile->factory, NULL);
+    profile->create_us = g_get_monotonic_time () - start;
+    if (element == NULL) {
+        profile->ready_failed = TRUE;
+        return;
+    }
+
+    start = g_get_monotonic_time ();
+    profile->ready_failed = gst_element_set_state (element,
+                                                   GST_STATE_READY) == GST_STATE_CHANGE_FAILURE;
+    profile->ready_us = g_get_monotonic_time () - start;
+    /* measured before going back down, what READY allocated is counted too */
+    profile->rss_delta = get_resident_size () - rss;
+
+    gst_element_set_state (element, GST_STATE_NULL);
+    gst_object_unref (element);
+}
+
+static void
+print_factory_profile_table (GArray * profiles, GCompareFunc compare,
+                             const gchar * title)
+{
+    guint i;
+
+    g_array_sort (profiles, compare);
+    g_print ("%s%s%s:\n", HEADING_COLOR, title, RESET_COLOR);
+    push_indent ();
+    for (i = 0; i < profiles->len && i < PROFILE_TOP_N; i++) {
+        FactoryProfile *profile = &g_array_index (profiles, FactoryProfile, i);
+
+        n_print ("%s%-24s%s %8.2f ms create %8.2f ms ready %8" G_GINT64_FORMAT
+                 " KiB  (%s)%s\n", FEATURE_NAME_COLOR,
+                 GST_OBJECT_NAME (profile->factory), RESET_COLOR,
+                 profile->create_us / 1000.0, profile->ready_us / 1000.0,
+                 profile->rss_delta / 1024, profile->plugin,
+                 profile->ready_failed ? " failed" : "");
+    }
+    pop_indent ();
+    g_print ("\n");
+}
+
+/* --profile: instantiate every element and bring it to READY, then report
+ * the slowest and heaviest ones, followed by one machine-readable
+ * "profile:factory,plugin,create_us,ready_us,rss_bytes,ok" line each */
+static void
+print_factory_profile (void)
+{
+    GArray *profiles = g_array_new (FALSE, FALSE, sizeof (FactoryProfile));
+    RegistryListing *listing = registry_listing_get ();
+    gint64 start = g_get_monotonic_time ();
+    guint i, p, f;
+
+    for (p = 0; p < listing->n_plugins && !inspect_cancelled (); p++) {
+        ListingPlugin *lp = &listing->plugins[p];
+        GstPlugin *plugin = lp->plugin;
+
+        if (GST_OBJECT_FLAG_IS_SET (plugin, GST_PLUGIN_FLAG_BLACKLISTED))
+            continue;
+
+        for (f = 0; f < lp->n_features && !inspect_cancelled (); f++) {
+            GstPluginFeature *feature = listing->features[lp->first_feature + f];
+            FactoryProfile profile = { NULL, };
+
+            if (!GST_IS_ELEMENT_FACTORY (feature))
+                continue;
+
+            /* loading the plugin is a one-off, keep it out of the numbers */
+            profile.factory = GST_ELEMENT_FACTORY (gst_plugin_feature_load (feature));
+            if (profile.factory == NULL)
+                continue;
+            profile.plugin = gst_plugin_get_name (plugin);
+            factory_profile_run (&profile);
+            g_array_append_val (profiles, profile);
+        }
+    }
+
+    GST_INFO ("Profiled %u factories in %" G_GINT64_FORMAT " ms", profiles->len,
+              (g_get_monotonic_time () - start) / 1000);
+
+    if (!inspect_cancelled ()) {
+        print_factory_profile_table (profiles, factory_profile_compare_time,
+                                     "Slowest to create and bring to READY");
+        print_factory_profile_table (profiles, factory_profile_compare_memory,
+                                     "Largest resident memory growth");
+
+        for (i = 0; i < profiles->len; i++) {
+            FactoryProfile *profile = &g_array_index (profiles, FactoryProfile, i);
+
+            n_print ("profile:%s,%s,%" G_GINT64_FORMAT ",%" G_GINT64_FORMAT ",%"
+                     G_GINT64_FORMAT ",%s\n", GST_OBJECT_NAME (profile->factory),
+                     profile->plugin, profile->create_us, profile->ready_us,
+                     profile->rss_delta, profile->ready_failed ? "failed" : "ok");
+        }
+    }
+
+    /* the plugin names are owned by the plugins, release them last */
+    for (i = 0; i < profiles->len; i++)
+        gst_object_unref (g_array_index (profiles, FactoryProfile, i).factory);
+    g_array_unref (profiles);
+    registry_listing_unref (listing);
+}
+
+/* Registry diff: the registry is compared against a snapshot saved by the
+ * previous --diff run. A plugin whose version and file are unchanged is
+ * carried over from the snapshot as is, only added and changed plugins
+ * have their features read again, from the registry's own metadata. No
+ * plugin gets loaded either way. */
+#define SNAPSHOT_PLUGIN_GROUP "plugin "
+#define SNAPSHOT_FEATURE_GROUP "feature "
+#define SNAPSHOT_PAD_KEY "pad "
+
+static gchar *
+registry_snapshot_path (void)
+{
+    return g_build_filename (g_get_user_cache_dir (), "gst-inspect-snapshot.ini",
+                             NULL);
+}
+
+static void
+snapshot_copy_group (GKeyFile * from, GKeyFile * to, const gchar * group)
+{
+    gchar **keys = g_key_file_get_keys (from, group, NULL, NULL);
+    gchar **key;
+
+    for (key = keys; key && *key; key++) {
+        gchar *value = g_key_file_get_value (from, group, *key, NULL);
+
+        g_key_file_set_value (to, group, *key, value);
+        g_free (value);
+    }
+    g_strfreev (keys);
+}
+
+static void
+snapshot_add_feature (GKeyFile * snapshot, GstPluginFeature * feature)
+{
+    gchar *group = g_strconcat (SNAPSHOT_FEATURE_GROUP, GST_OBJECT_NAME (feature),
+                                NULL);
+
+    g_key_file_set_string (snapshot, group, "plugin",
+                           GST_STR_NULL (gst_plugin_feature_get_plugin_name (feature)));
+    g_key_file_set_string (snapshot, group, "type",
+                           G_OBJECT_TYPE_NAME (feature));
+    g_key_file_set_integer (snapshot, group, "rank",
+                            gst_plugin_feature_get_rank (feature));
+
+    if (GST_IS_ELEMENT_FACTORY (feature)) {
+        const GList *pads;
+
+        for (pads = gst_element_factory_get_static_pad_templates
+                     (GST_ELEMENT_FACTORY (feature)); pads; pads = pads->next) {
+            GstStaticPadTemplate *padtemplate = pads->data;
+            gchar *key = g_strconcat (SNAPSHOT_PAD_KEY, padtemplate->name_template,
+                                      NULL);
+            GstCaps *caps = gst_static_pad_template_get_caps (padtemplate);
+            gchar *caps_str = gst_caps_to_string (caps);
+            gchar *value = g_strdup_printf ("%s %s",
+                                            padtemplate->direction == GST_PAD_SRC ? "src" : "sink", caps_str);
+
+            g_key_file_set_string (snapshot, group, key, value);
+            g_free (value);
+            g_free (caps_str);
+            gst_caps_unref (caps);
+            g_free (key);
+        }
+    }
+    g_free (group);
+}
+
+/* Record @plugin and its features in @snapshot, reusing what @old has for
+ * it when the plugin did not change. Returns whether it did. */
+static gboolean
+snapshot_add_plugin (GKeyFile * snapshot, GKeyFile * old, GstPlugin * plugin)
+{
+    const gchar *name = gst_plugin_get_name (plugin);
+    gchar *group = g_strconcat (SNAPSHOT_PLUGIN_GROUP, name, NULL);
+    const gchar *filename = "";
+    const gchar *version = GST_STR_NULL (gst_plugin_get_version (plugin));
+    gint64 mtime = 0;
+    guint64 size = 0;
+    gboolean unchanged = FALSE;
+    gchar *old_filename, *old_version;
+
+    plugin_file_identity (plugin, &filename, &mtime, &size);
+
+    old_filename = g_key_file_get_string (old, group, "filename", NULL);
+    old_version = g_key_file_get_string (old, group, "version", NULL);
+    if (old_filename != NULL && old_version != NULL
+        && !strcmp (old_filename, filename) && !strcmp (old_version, version)
+        && g_key_file_get_int64 (old, group, "mtime", NULL) == mtime
+        && g_key_file_get_uint64 (old, group, "size", NULL) == size)
+        unchanged = TRUE;
+    g_free (old_filename);
+    g_free (old_version);
+
+    if (unchanged) {
+        gchar **features = g_key_file_get_string_list (old, group, "features",
+                                                       NULL, NULL);
+        gchar **f;
+
+        snapshot_copy_group (old, snapshot, group);
+        for (f = features; f && *f; f++) {
+            gchar *feature_group = g_strconcat (SNAPSHOT_FEATURE_GROUP, *f, NULL);
+            GstPluginFeature *feature;
+
+            snapshot_copy_group (old, snapshot, feature_group);
+            /* ranks can be changed without touching the file, and the
+             * registry has them without loading the plugin */
+            feature = gst_registry_lookup_feature (gst_registry_get (), *f);
+            if (feature != NULL) {
+                g_key_file_set_integer (snapshot, feature_group, "rank",
+                                        gst_plugin_feature_get_rank (feature));
+                gst_object_unref (feature);
+            }
+            g_free (feature_group);
+        }
+        g_strfreev (features);
+    } else {
+        GList *features, *f;
+        GPtrArray *names = g_ptr_array_new ();
+
+        g_key_file_set_string (snapshot, group, "filename", filename);
+        g_key_file_set_string (snapshot, group, "version", version);
+        g_key_file_set_int64 (snapshot, group, "mtime", mtime);
+        g_key_file_set_uint64 (snapshot, group, "size", size);
+
+        features = gst_registry_get_feature_list_by_plugin (gst_registry_get (), name);
+        features = g_list_sort (features, gst_plugin_feature_name_compare_func);
+        for (f = features; f; f = f->next) {
+            snapshot_add_feature (snapshot, GST_PLUGIN_FEATURE (f->data));
+            g_ptr_array_add (names, GST_OBJECT_NAME (f->data));
+        }
+        g_key_file_set_string_list (snapshot, group, "features",
+                                    (const gchar * const *) names->pdata, names->len);
+        g_ptr_array_unref (names);
+        gst_plugin_feature_list_free (features);
+    }
+
+    g_free (group);
+    return unchanged;
+}
+
+static gint
+snapshot_name_compare (gconstpointer a, gconstpointer b)
+{
+    return strcmp (*(const gchar **) a, *(const gchar **) b);
+}
+
+/* Groups of @snapshot starting with @prefix, without it, sorted */
+static GPtrArray *
+snapshot_names (GKeyFile * snapshot, const gchar * prefix)
+{
+    GPtrArray *names = g_ptr_array_new_with_free_func (g_free);
+    gchar **groups = g_key_file_get_groups (snapshot, NULL);
+    gchar **g;
+
+    for (g = groups; *g; g++)
+        if (g_str_has_prefix (*g, prefix))
+            g_ptr_array_add (names, g_strdup (*g + strlen (prefix)));
+    g_strfreev (groups);
+    g_ptr_array_sort (names, snapshot_name_compare);
+    return names;
+}
+
+static void
+print_feature_diff (GKeyFile * old, GKeyFile * snapshot, const gchar * name)
+{
+    gchar *group = g_strconcat (SNAPSHOT_FEATURE_GROUP, name, NULL);
+    gint old_rank = g_key_file_get_integer (old, group, "rank", NULL);
+    gint rank = g_key_file_get_integer (snapshot, group, "rank", NULL);
+    gchar **keys, **key;
+
+    if (old_rank != rank)
+        g_print ("rank-changed %s %d %d\n", name, old_rank, rank);
+
+    /* templates that are gone or changed, then the new ones */
+    keys = g_key_file_get_keys (old, group, NULL, NULL);
+    for (key = keys; key && *key; key++) {
+        gchar *old_value, *value;
+
+        if (!g_str_has_prefix (*key, SNAPSHOT_PAD_KEY))
+            continue;
+        old_value = g_key_file_get_string (old, group, *key, NULL);
+        value = g_key_file_get_string (snapshot, group, *key, NULL);
+        if (value == NULL)
+            g_print ("pad-removed %s %s\n", name, *key + strlen (SNAPSHOT_PAD_KEY));
+        else if (g_strcmp0 (old_value, value))
+            g_print ("caps-changed %s %s %s -> %s\n", name,
+                     *key + strlen (SNAPSHOT_PAD_KEY), old_value, value);
+        g_free (old_value);
+        g_free (value);
+    }
+    g_strfreev (keys);
+
+    keys = g_key_file_get_keys (snapshot, group, NULL, NULL);
+    for (key = keys; key && *key; key++) {
+        gchar *value;
+
+        if (!g_str_has_prefix (*key, SNAPSHOT_PAD_KEY)
+            || g_key_file_has_key (old, group, *key, NULL))
+            continue;
+        value = g_key_file_get_string (snapshot, group, *key, NULL);
+        g_print ("pad-added %s %s %s\n", name, *key + strlen (SNAPSHOT_PAD_KEY),
+                 value);
+        g_free (value);
+    }
+    g_strfreev (keys);
+    g_free (group);
+}
+
+/* --diff: print what changed in the registry since the last --diff, one
+ * "<change> <name> ..." line each, then save the current state */
+static int
+print_registry_diff (void)
+{
+    GKeyFile *old = g_key_file_new ();
+    GKeyFile *snapshot = g_key_file_new ();
+    gchar *path = registry_snapshot_path ();
+    GPtrArray *old_features, *features;
+    GList *plugins, *p;
+    GHashTable *changed = g_hash_table_new (g_str_hash, g_str_equal);
+    GError *err = NULL;
+    gboolean have_old;
+    guint i, j, n_unchanged = 0;
+    gchar *data;
+    gsize length;
+
+    have_old = g_key_file_load_from_file (old, path, G_KEY_FILE_NONE, NULL);
+
+    plugins = gst_registry_get_plugin_list (gst_registry_get ());
+    for (p = plugins; p; p = p->next) {
+        GstPlugin *plugin = p->data;
+
+        if (GST_OBJECT_FLAG_IS_SET (plugin, GST_PLUGIN_FLAG_BLACKLISTED))
+            continue;
+        if (snapshot_add_plugin (snapshot, old, plugin))
+            n_unchanged++;
+        else
+            g_hash_table_add (changed, (gpointer) gst_plugin_get_name (plugin));
+    }
+
+    if (!have_old) {
+        g_print ("No snapshot to compare with, saving the current registry\n");
+    } else {
+        GPtrArray *old_plugins = snapshot_names (old, SNAPSHOT_PLUGIN_GROUP);
+        GPtrArray *new_plugins = snapshot_names (snapshot, SNAPSHOT_PLUGIN_GROUP);
+
+        for (i = 0; i < new_plugins->len; i++) {
+            const gchar *name = g_ptr_array_index (new_plugins, i);
+            gchar *group = g_strconcat (SNAPSHOT_PLUGIN_GROUP, name, NULL);
+            gchar *old_version = g_key_file_get_string (old, group, "version", NULL);
+            gchar *version = g_key_file_get_string (snapshot, group, "version", NULL);
+
+            if (old_version == NULL)
+                g_print ("plugin-added %s %s\n", name, version);
+            else if (strcmp (old_version, version))
+                g_print ("plugin-changed %s %s -> %s\n", name, old_version, version);
+            g_free (old_version);
+            g_free (version);
+            g_free (group);
+        }
+        for (i = 0; i < old_plugins->len; i++) {
+            gchar *group = g_strconcat (SNAPSHOT_PLUGIN_GROUP,
+                                        (gchar *) g_ptr_array_index (old_plugins, i), NULL);
+
+            if (!g_key_file_has_group (snapshot, group))
+                g_print ("plugin-removed %s\n", (gchar *) g_ptr_array_index (old_plugins, i));
+            g_free (group);
+        }
+
+        /* walk both sorted feature lists side by side */
+        old_features = snapshot_names (old, SNAPSHOT_FEATURE_GROUP);
+        features = snapshot_names (snapshot, SNAPSHOT_FEATURE_GROUP);
+        for (i = 0, j = 0; i < old_features->len || j < features->len;) {
+            const gchar *old_name = i < old_features->len ?
+                    g_ptr_array_index (old_features, i) : NULL;
+            const gchar *name = j < features->len ? g_ptr_array_index (features, j) : NULL;
+            gint cmp = old_name == NULL ? 1 : name == NULL ? -1 : strcmp (old_name, name);
+
+            if (cmp < 0) {
+                g_print ("feature-removed %s\n", old_name);
+                i++;
+            } else if (cmp > 0) {
+                gchar *group = g_strconcat (SNAPSHOT_FEATURE_GROUP, name, NULL);
+                gchar *plugin = g_key_file_get_string (snapshot, group, "plugin", NULL);
+
+                g_print ("feature-added %s %s\n", name, plugin);
+                g_free (plugin);
+                g_free (group);
+                j++;
+            } else {
+                gchar *group = g_strconcat (SNAPSHOT_FEATURE_GROUP, name, NULL);
+                gchar *plugin = g_key_file_get_string (snapshot, group, "plugin", NULL);
+
+                /* features of unchanged plugins were copied over verbatim */
+                if (plugin && g_hash_table_contains (changed, plugin))
+                    print_feature_diff (old, snapshot, name);
+                g_free (plugin);
+                g_free (group);
+                i++;
+                j++;
+            }
+        }
+        g_ptr_array_unref (old_features);
+        g_ptr_array_unref (features);
+        g_ptr_array_unref (old_plugins);
+        g_ptr_array_unref (new_plugins);
+    }
+
+    GST_INFO ("Registry diff: %u plugins unchanged, %u re-read", n_unchanged,
+              g_hash_table_size (changed));
+
+    data = g_key_file_to_data (snapshot, &length, NULL);
+    if (!g_file_set_contents (path, data, length, &err)) {
+        GST_WARNING ("Could not save registry snapshot: %s", err->message);
+        g_clear_error (&err);
+    }
+
+    g_free (data);
+    g_hash_table_unref (changed);
+    gst_plugin_list_free (plugins);
+    g_key_file_free (snapshot);
+    g_key_file_free (old);
+    g_free (path);
+    return 0;
+}
+
+/* Batch --exists: resolve many "name[>=version]" specs against one hash of
+ * the registry's feature (or plugin) names instead of a lookup each */
+static gboolean
+version_at_least (const gchar * version, guint major, guint minor, guint micro)
+{
+    guint v_major = 0, v_minor = 0, v_micro = 0;
+
+    if (version == NULL
+        || sscanf (version, "%u.%u.%u", &v_major, &v_minor, &v_micro) < 2)
+        return FALSE;
+    if (v_major != major)
+        return v_major > major;
+    if (v_minor != minor)
+        return v_minor > minor;
+    return v_micro >= micro;
+}
+
+/* Check every spec in @specs, setting bit i of @bits (which must hold
+ * @n_specs bits, zeroed) for each one that is satisfied. Specs without a
+ * version of their own are checked against @major.@minor.@micro. The
+ * unsatisfied specs are added to @missing if given. Returns how many there
+ * are, or -1 if a spec can't be parsed. */
+static gint
+check_exists_batch (const gchar * const *specs, guint n_specs,
+                    gboolean plugins, guint major, guint minor, guint micro,
+                    guint8 * bits, GPtrArray * missing)
+{
+    GHashTable *names = g_hash_table_new (g_str_hash, g_str_equal);
+    GList *list, *l;
+    gint n_missing = 0;
+    guint i;
+
+    if (plugins)
+        list = gst_registry_get_plugin_list (gst_registry_get ());
+    else
+        list = gst_registry_get_feature_list (gst_registry_get (),
+                                              GST_TYPE_PLUGIN_FEATURE);
+    for (l = list; l != NULL; l = l->next)
+        g_hash_table_insert (names, plugins ?
+                             (gpointer) gst_plugin_get_name (l->data) :
+                             (gpointer) GST_OBJECT_NAME (l->data), l->data);
+
+    for (i = 0; i < n_specs; i++) {
+        const gchar *op = strstr (specs[i], ">=");
+        guint s_major = major, s_minor = minor, s_micro = micro;
+        gchar *name;
+        gpointer found;
+        gboolean ok;
+
+        if (op != NULL) {
+            s_micro = 0;
+            if (sscanf (op + 2, "%u.%u.%u", &s_major, &s_minor, &s_micro) < 2) {
+                g_printerr ("Can't parse version in '%s'\n", specs[i]);
+                n_missing = -1;
+                break;
+            }
+            name = g_strstrip (g_strndup (specs[i], op - specs[i]));
+        } else {
+            name = g_strstrip (g_strdup (specs[i]));
+        }
+
+        found = g_hash_table_lookup (names, name);
+        if (found == NULL)
+            ok = FALSE;
+        else if (plugins)
+            ok = version_at_least (gst_plugin_get_version (found), s_major, s_minor,
+                                   s_micro);
+        else
+            ok = gst_plugin_feature_check_version (found, s_major, s_minor, s_micro);
+
+        if (ok) {
+            bits[i / 8] |= 1 << (i % 8);
+        } else {
+            n_missing++;
+            if (missing)
+                g_ptr_array_add (missing, g_strdup (specs[i]));
+        }
+        g_free (name);
+    }
+
+    g_hash_table_unref (names);
+    if (plugins)
+        gst_plugin_list_free (list);
+    else
+        gst_plugin_feature_list_free (list);
+    return n_missing;
+}
+
+/* "pads,properties" -> mask of InspectSections, 0 on error */
+static guint
+parse_inspect_sections (const gchar * str)
+{
+    static const struct
+    {
+        const gchar *name;
+        guint section;
+    } names[] = {
+            {"details", INSPECT_SECTION_DETAILS},
+            {"hierarchy", INSPECT_SECTION_HIERARCHY},
+            {"interfaces", INSPECT_SECTION_INTERFACES},
+            {"pad-templates", INSPECT_SECTION_PAD_TEMPLATES},
+            {"clocking", INSPECT_SECTION_CLOCKING},
+            {"uri-handler", INSPECT_SECTION_URI_HANDLER},
+            {"pads", INSPECT_SECTION_PADS},
+            {"properties", INSPECT_SECTION_PROPERTIES},
+            {"signals", INSPECT_SECTION_SIGNALS},
+            {"children", INSPECT_SECTION_CHILDREN},
+            {"presets", INSPECT_SECTION_PRESETS},
+            {"all", INSPECT_SECTION_ALL},
+    };
+    gchar **tokens = g_strsplit (str, ",", -1);
+    guint mask = 0, i, j;
+
+    for (i = 0; tokens[i] != NULL; i++) {
+        g_strstrip (tokens[i]);
+        for (j = 0; j < G_N_ELEMENTS (names); j++)
+            if (!strcmp (tokens[i], names[j].name))
+                break;
+        if (j == G_N_ELEMENTS (names)) {
+            g_printerr ("Unknown section '%s'\n", tokens[i]);
+            mask = 0;
+            break;
+        }
+        mask |= names[j].section;
+    }
+    g_strfreev (tokens);
+    return mask;
 }
-#endif
 
 static gboolean
 _parse_sort_type (const gchar * option_name, const gchar * optarg,
@@ -2031,6 +5726,24 @@ GST_DEBUG_CATEGORY_STATIC (debug_category);
 # define SET_CUSTOM_DATA(env, thiz, fieldID, data) (*env)->SetLongField (env, thiz, fieldID, (jlong)(jint)data)
 #endif
 
+/* The output of the current request, kept natively: Java only gets told
+ * how many lines there are and fetches the ones it shows with
+ * nativeGetLines(), instead of laying out all of the text at once. That
+ * keeps the whole output in native memory, where streaming it out in
+ * chunks kept only one chunk, so it is capped: past
+ * OUTPUT_LINES_MAX_SIZE the rest of the request is dropped and a line
+ * says so. A full -a dump stays well below that. */
+#define OUTPUT_LINES_MAX_SIZE (32 * 1024 * 1024)
+
+typedef struct _OutputLines
+{
+  GString *text;                /* Everything the request printed so far */
+  GArray *ends;                 /* guint32 offset in text of each line's end */
+  gint request_id;              /* Request the lines belong to */
+  gboolean truncated;           /* Hit OUTPUT_LINES_MAX_SIZE */
+  GMutex lock;                  /* Written on the app thread, read on the UI thread */
+} OutputLines;
+
 /* Structure to contain all our information, so we can pass it to callbacks */
 typedef struct _CustomData
 {
@@ -2039,15 +5752,26 @@ typedef struct _CustomData
   GMainContext *context;        /* GLib context used to run the main loop */
   GMainLoop *main_loop;         /* GLib main loop */
   gboolean initialized;         /* To avoid informing the UI multiple times about the initialization */
+  OutputLines lines;            /* Output of the current request */
+  GString *output_str;          /* Output buffer, reused by every request */
 } CustomData;
 
+/* One nativeInspect() call, queued on the app_function thread */
+typedef struct _InspectRequest
+{
+  gint id;                      /* Handed back to Java in onInspectCompleted() */
+  gchar *module_name;           /* What the user typed, may be empty */
+  CustomData *data;
+} InspectRequest;
+
 /* These global variables cache values which are not changing during execution */
 static pthread_t gst_app_thread;
 static pthread_key_t current_jni_env;
 static JavaVM *java_vm;
 static jfieldID custom_data_field_id;
-static jmethodID set_message_method_id;
+static jmethodID on_lines_available_method_id;
 static jmethodID on_gstreamer_initialized_method_id;
+static jmethodID on_inspect_completed_method_id;
 
 /*
  * Private methods
@@ -2095,19 +5819,494 @@ get_jni_env (void)
   return env;
 }
 
-/* Change the content of the UI's TextView */
+/* Tell the UI how many lines the current request has printed so far */
+static void
+notify_lines_available (gint request_id, guint n_lines, CustomData * data)
+{
+  JNIEnv *env = get_jni_env ();
+  (*env)->CallVoidMethod (env, data->app, on_lines_available_method_id,
+      (jint) request_id, (jint) n_lines);
+  if ((*env)->ExceptionCheck (env)) {
+    GST_ERROR ("Failed to call Java method");
+    (*env)->ExceptionClear (env);
+  }
+}
+
+/* Start collecting the output of @request_id */
+static void
+output_lines_reset (gint request_id, CustomData * data)
+{
+  OutputLines *lines = &data->lines;
+
+  g_mutex_lock (&lines->lock);
+  g_string_truncate (lines->text, 0);
+  g_array_set_size (lines->ends, 0);
+  lines->request_id = request_id;
+  lines->truncated = FALSE;
+  g_mutex_unlock (&lines->lock);
+
+  notify_lines_available (request_id, 0, data);
+}
+
+/* Flush function of a request's output: index the line ends in the chunk
+ * and keep it. Chunks are cut at line ends, except the very last one,
+ * which output_lines_finish() takes care of. */
+static void
+output_lines_store (const gchar * text, gsize len, gpointer user_data)
+{
+  CustomData *data = (CustomData *) user_data;
+  OutputLines *lines = &data->lines;
+  const gchar *p = text, *end = text + len, *nl;
+  gint request_id;
+  guint n_lines;
+
+  g_mutex_lock (&lines->lock);
+  if (lines->truncated) {
+    g_mutex_unlock (&lines->lock);
+    return;
+  }
+  if (lines->text->len + len > OUTPUT_LINES_MAX_SIZE) {
+    /* keep the whole lines that fit, then say what happened */
+    const gchar *cut = text;
+
+    while ((nl = memchr (cut, '\n', end - cut)) != NULL
+        && lines->text->len + (nl + 1 - text) <= OUTPUT_LINES_MAX_SIZE)
+      cut = nl + 1;
+    len = cut - text;
+    end = cut;
+    lines->truncated = TRUE;
+  }
+  while ((nl = memchr (p, '\n', end - p)) != NULL) {
+    guint32 offset = lines->text->len + (nl - text);
+
+    g_array_append_val (lines->ends, offset);
+    p = nl + 1;
+  }
+  g_string_append_len (lines->text, text, len);
+  if (lines->truncated) {
+    guint32 offset;
+
+    if (lines->text->len > 0
+        && lines->text->str[lines->text->len - 1] != '\n') {
+      offset = lines->text->len;
+      g_array_append_val (lines->ends, offset);
+      g_string_append_c (lines->text, '\n');
+    }
+    g_string_append_printf (lines->text,
+        "[output truncated at %d MiB, narrow the request]",
+        OUTPUT_LINES_MAX_SIZE / (1024 * 1024));
+    offset = lines->text->len;
+    g_array_append_val (lines->ends, offset);
+    g_string_append_c (lines->text, '\n');
+    GST_WARNING ("Output of request %d truncated", lines->request_id);
+  }
+  request_id = lines->request_id;
+  n_lines = lines->ends->len;
+  g_mutex_unlock (&lines->lock);
+
+  notify_lines_available (request_id, n_lines, data);
+}
+
+/* Count an unterminated last line as well */
+static void
+output_lines_finish (CustomData * data)
+{
+  OutputLines *lines = &data->lines;
+  guint32 last_end;
+  gboolean added = FALSE;
+
+  g_mutex_lock (&lines->lock);
+  last_end = lines->ends->len ?
+      g_array_index (lines->ends, guint32, lines->ends->len - 1) + 1 : 0;
+  if (lines->text->len > last_end) {
+    guint32 offset = lines->text->len;
+
+    g_array_append_val (lines->ends, offset);
+    added = TRUE;
+  }
+  g_mutex_unlock (&lines->lock);
+
+  if (added)
+    notify_lines_available (lines->request_id, lines->ends->len, data);
+}
+
+/* Tell the UI a request is finished, either run to the end or dropped */
 static void
-set_ui_message (const gchar * message, CustomData * data)
+notify_inspect_completed (gint request_id, gboolean cancelled, gint exit_code,
+    CustomData * data)
 {
   JNIEnv *env = get_jni_env ();
-  GST_DEBUG ("Setting message to: %s", message);
-  jstring jmessage = (*env)->NewStringUTF (env, message);
-  (*env)->CallVoidMethod (env, data->app, set_message_method_id, jmessage);
+  GST_DEBUG ("Request %d %s (exit code %d)", request_id,
+      cancelled ? "cancelled" : "completed", exit_code);
+  (*env)->CallVoidMethod (env, data->app, on_inspect_completed_method_id,
+      (jint) request_id, (jboolean) cancelled, (jint) exit_code);
   if ((*env)->ExceptionCheck (env)) {
     GST_ERROR ("Failed to call Java method");
     (*env)->ExceptionClear (env);
   }
-  (*env)->DeleteLocalRef (env, jmessage);
+}
+
+/* Discards what a benchmark prints, counting the bytes */
+static void
+benchmark_flush (const gchar * text, gsize len, gpointer user_data)
+{
+    *(guint64 *) user_data += len;
+}
+
+/* One full print_all walk on @jobs threads, bypassing the inspect index */
+static gint64
+benchmark_print_all (NPrintStats * stats, guint64 * bytes, gint jobs)
+{
+    InspectOutput *saved_output = output;
+    InspectOutput sink = { NULL, OUTPUT_CHUNK_SIZE, benchmark_flush, bytes };
+    gint saved_jobs = inspect_jobs;
+    gint64 start;
+
+    sink.str = g_string_sized_new (2 * OUTPUT_CHUNK_SIZE);
+    output = &sink;
+    n_print_stats = stats;
+    inspect_index_bypass = TRUE;
+    inspect_jobs = jobs;
+
+    start = g_get_monotonic_time ();
+    print_element_list (TRUE, NULL);
+    inspect_output_flush (&sink, TRUE);
+    start = g_get_monotonic_time () - start;
+
+    inspect_jobs = saved_jobs;
+    inspect_index_bypass = FALSE;
+    n_print_stats = NULL;
+    output = saved_output;
+    g_string_free (sink.str, TRUE);
+
+    return start;
+}
+
+/* --benchmark-print: a print_all run formatting every line through
+ * gst_info_strdup_vprintf(), as n_print() used to, against the current
+ * formatter. Allocations are the ones n_print() itself makes. */
+static void
+benchmark_print_formatter (void)
+{
+    NPrintStats legacy = { TRUE, 0, 0 }, direct = { FALSE, 0, 0 };
+    guint64 legacy_bytes = 0, direct_bytes = 0;
+    gint64 legacy_us, direct_us;
+
+    /* a first walk loads every plugin, so neither run pays for that */
+    benchmark_print_all (&direct, &direct_bytes, 1);
+    direct.calls = direct.allocs = direct_bytes = 0;
+
+    legacy_us = benchmark_print_all (&legacy, &legacy_bytes, 1);
+    direct_us = benchmark_print_all (&direct, &direct_bytes, 1);
+
+    n_print ("%sn_print() benchmark%s:\n", HEADING_COLOR, RESET_COLOR);
+    push_indent ();
+    n_print ("%s%-25s%s%" G_GINT64_FORMAT " us, %" G_GUINT64_FORMAT
+        " allocations for %" G_GUINT64_FORMAT " lines, %" G_GUINT64_FORMAT
+        " bytes%s\n", PROP_NAME_COLOR, "gst_info_strdup_vprintf",
+        PROP_VALUE_COLOR, legacy_us, legacy.allocs, legacy.calls, legacy_bytes,
+        RESET_COLOR);
+    n_print ("%s%-25s%s%" G_GINT64_FORMAT " us, %" G_GUINT64_FORMAT
+        " allocations for %" G_GUINT64_FORMAT " lines, %" G_GUINT64_FORMAT
+        " bytes%s\n", PROP_NAME_COLOR, "In place", PROP_VALUE_COLOR,
+        direct_us, direct.allocs, direct.calls, direct_bytes, RESET_COLOR);
+    pop_indent ();
+
+    GST_INFO ("n_print: %" G_GINT64_FORMAT " us / %" G_GUINT64_FORMAT
+        " allocations before, %" G_GINT64_FORMAT " us / %" G_GUINT64_FORMAT
+        " allocations after", legacy_us, legacy.allocs, direct_us, direct.allocs);
+}
+
+/* --benchmark-jobs: the wall-clock time of -a introspecting serially
+ * against -a on -j threads (one per CPU by default), neither served from
+ * the inspect index */
+static void
+benchmark_parallel (void)
+{
+    NPrintStats stats = { FALSE, 0, 0 };
+    guint64 serial_bytes = 0, parallel_bytes = 0;
+    gint64 serial_us, parallel_us;
+    gint n_threads = inspect_jobs > 1 ? inspect_jobs : g_get_num_processors ();
+
+    /* a first walk loads every plugin, so neither run pays for that */
+    benchmark_print_all (&stats, &serial_bytes, 1);
+    serial_bytes = 0;
+
+    serial_us = benchmark_print_all (&stats, &serial_bytes, 1);
+    parallel_us = benchmark_print_all (&stats, &parallel_bytes, n_threads);
+
+    n_print ("%s-a benchmark%s (%u CPUs):\n", HEADING_COLOR, RESET_COLOR,
+        g_get_num_processors ());
+    push_indent ();
+    n_print ("%s%-25s%s%.3f s for %" G_GUINT64_FORMAT " bytes%s\n",
+        PROP_NAME_COLOR, "-j 1", PROP_VALUE_COLOR,
+        serial_us / (gdouble) G_USEC_PER_SEC, serial_bytes, RESET_COLOR);
+    n_print ("%s-j %-22d%s%.3f s for %" G_GUINT64_FORMAT " bytes%s\n",
+        PROP_NAME_COLOR, n_threads, PROP_VALUE_COLOR,
+        parallel_us / (gdouble) G_USEC_PER_SEC, parallel_bytes, RESET_COLOR);
+    n_print ("%s%-25s%s%.2fx%s\n", PROP_NAME_COLOR, "Speedup",
+        PROP_VALUE_COLOR, parallel_us > 0 ? serial_us / (gdouble) parallel_us : 0.0,
+        RESET_COLOR);
+    pop_indent ();
+
+    GST_INFO ("-a: %" G_GINT64_FORMAT " us serially, %" G_GINT64_FORMAT
+        " us on %d threads", serial_us, parallel_us, n_threads);
+}
+
+/* One print_all walk on this thread bypassing the inspect index, captured
+ * as text without colors or as JSON lines */
+static GString *
+benchmark_capture_all (gboolean json, gint64 * elapsed_us)
+{
+    InspectOutput *saved_output = output;
+    InspectOutput capture = { NULL, G_MAXSIZE, NULL, NULL };
+    gboolean saved_json = inspect_json, saved_colors = colored_output;
+    gint saved_jobs = inspect_jobs;
+    gint64 start;
+
+    capture.str = g_string_sized_new (1024 * 1024);
+    output = &capture;
+    inspect_json = json;
+    colored_output = FALSE;
+    inspect_index_bypass = TRUE;
+    inspect_jobs = 1;
+
+    start = g_get_monotonic_time ();
+    print_element_list (TRUE, NULL);
+    if (elapsed_us)
+        *elapsed_us = g_get_monotonic_time () - start;
+
+    inspect_jobs = saved_jobs;
+    inspect_index_bypass = FALSE;
+    colored_output = saved_colors;
+    inspect_json = saved_json;
+    output = saved_output;
+
+    return capture.str;
+}
+
+/* Read the details back out of the text the way a scraper has to: every
+ * line is matched against the shapes they are printed in until one fits,
+ * and its fields are extracted. Returns the number of fields. */
+static guint
+benchmark_scrape_text (const GString * text)
+{
+    static const gchar *const patterns[] = {
+        "^\\s+flags: (.*)$",
+        "^\\s+([\\w ]+)\\. (?:Range: (\\S+) - (\\S+) )?Default: (.*)$",
+        "^\\s+(SRC|SINK|UNKNOWN) template: '([^']*)'$",
+        "^\\s+\\((-?\\d+)\\): (\\S+)\\s+- (.*)$",
+        "^\\s+([\\w-]+)\\s*: (.*)$",
+        "^\\s+(\\S[\\w -]*?)\\s{2,}(\\S.*)$",
+        "^(\\S[\\w ]*):$",
+    };
+    GRegex *regexes[G_N_ELEMENTS (patterns)];
+    GString *line = g_string_new (NULL);
+    const gchar *p = text->str, *end = text->str + text->len;
+    guint n_fields = 0, i;
+
+    for (i = 0; i < G_N_ELEMENTS (patterns); i++)
+        regexes[i] = g_regex_new (patterns[i], G_REGEX_OPTIMIZE, 0, NULL);
+
+    while (p < end) {
+        const gchar *eol = memchr (p, '\n', end - p);
+
+        if (eol == NULL)
+            eol = end;
+        g_string_truncate (line, 0);
+        g_string_append_len (line, p, eol - p);
+        p = eol + 1;
+
+        for (i = 0; i < G_N_ELEMENTS (regexes); i++) {
+            GMatchInfo *info = NULL;
+            gint group;
+
+            if (g_regex_match_full (regexes[i], line->str, line->len, 0, 0,
+                                    &info, NULL)) {
+                for (group = 1; group < g_match_info_get_match_count (info);
+                     group++) {
+                    g_free (g_match_info_fetch (info, group));
+                    n_fields++;
+                }
+                g_match_info_free (info);
+                break;
+            }
+            g_match_info_free (info);
+        }
+    }
+
+    for (i = 0; i < G_N_ELEMENTS (regexes); i++)
+        g_regex_unref (regexes[i]);
+    g_string_free (line, TRUE);
+
+    return n_fields;
+}
+
+/* A minimal JSON reader for the benchmark: checks the value at @p, counting
+ * its keys and scalars and unescaping every string into @scratch, as a
+ * consumer has to. Returns where the value ends, NULL if it is malformed. */
+static const gchar *
+json_scan_value (const gchar * p, GString * scratch, guint * n_fields)
+{
+    gchar *end;
+
+    while (*p == ' ')
+        p++;
+
+    if (*p == '{' || *p == '[') {
+        gchar close = *p == '{' ? '}' : ']';
+
+        for (p++; *p == ' '; p++);
+        if (*p == close)
+            return p + 1;
+
+        while (TRUE) {
+            if (close == '}') {
+                if (*p != '"' || !(p = json_scan_value (p, scratch, n_fields)))
+                    return NULL;
+                for (; *p == ' '; p++);
+                if (*p++ != ':')
+                    return NULL;
+            }
+            if (!(p = json_scan_value (p, scratch, n_fields)))
+                return NULL;
+            for (; *p == ' '; p++);
+            if (*p == close)
+                return p + 1;
+            if (*p++ != ',')
+                return NULL;
+        }
+    }
+
+    (*n_fields)++;
+
+    if (*p == '"') {
+        g_string_truncate (scratch, 0);
+        for (p++; *p != '"'; p++) {
+            if (*p == '\0' || *p == '\n')
+                return NULL;
+            if (*p != '\\') {
+                g_string_append_c (scratch, *p);
+                continue;
+            }
+            switch (*++p) {
+                case '"':
+                case '\\':
+                case '/':
+                    g_string_append_c (scratch, *p);
+                    break;
+                case 'n':
+                    g_string_append_c (scratch, '\n');
+                    break;
+                case 't':
+                    g_string_append_c (scratch, '\t');
+                    break;
+                case 'r':
+                    g_string_append_c (scratch, '\r');
+                    break;
+                case 'b':
+                    g_string_append_c (scratch, '\b');
+                    break;
+                case 'f':
+                    g_string_append_c (scratch, '\f');
+                    break;
+                case 'u':
+                {
+                    gunichar c = 0;
+                    gint i, digit;
+
+                    for (i = 1; i <= 4; i++) {
+                        if ((digit = g_ascii_xdigit_value (p[i])) < 0)
+                            return NULL;
+                        c = (c << 4) | digit;
+                    }
+                    g_string_append_unichar (scratch, c);
+                    p += 4;
+                    break;
+                }
+                default:
+                    return NULL;
+            }
+        }
+        return p + 1;
+    }
+
+    if (!strncmp (p, "true", 4) || !strncmp (p, "null", 4))
+        return p + 4;
+    if (!strncmp (p, "false", 5))
+        return p + 5;
+
+    g_ascii_strtod (p, &end);
+    return end != p ? end : NULL;
+}
+
+/* Returns the number of fields, and the lines read and how many of them
+ * weren't a single well formed JSON value */
+static guint
+benchmark_parse_json (const GString * json, guint * n_lines, guint * n_bad)
+{
+    GString *scratch = g_string_new (NULL);
+    const gchar *p = json->str, *end = json->str + json->len;
+    guint n_fields = 0;
+
+    while (p < end) {
+        const gchar *eol = memchr (p, '\n', end - p);
+        const gchar *value_end = json_scan_value (p, scratch, &n_fields);
+
+        if (eol == NULL)
+            eol = end;
+        (*n_lines)++;
+        if (value_end != eol)
+            (*n_bad)++;
+        p = eol + 1;
+    }
+
+    g_string_free (scratch, TRUE);
+    return n_fields;
+}
+
+/* --benchmark-json: getting the details of every element back out of a
+ * print_all run, scraping the text against reading the --json output */
+static void
+benchmark_json_parse (void)
+{
+    GString *text, *json;
+    gint64 text_us, json_us, scrape_us, parse_us, start;
+    guint text_fields, json_fields, json_lines = 0, bad_lines = 0;
+
+    /* a first walk loads every plugin, so neither run pays for that */
+    g_string_free (benchmark_capture_all (FALSE, NULL), TRUE);
+
+    text = benchmark_capture_all (FALSE, &text_us);
+    json = benchmark_capture_all (TRUE, &json_us);
+
+    start = g_get_monotonic_time ();
+    text_fields = benchmark_scrape_text (text);
+    scrape_us = g_get_monotonic_time () - start;
+
+    start = g_get_monotonic_time ();
+    json_fields = benchmark_parse_json (json, &json_lines, &bad_lines);
+    parse_us = g_get_monotonic_time () - start;
+
+    n_print ("%sStructured output benchmark%s:\n", HEADING_COLOR, RESET_COLOR);
+    push_indent ();
+    n_print ("%s%-25s%s%" G_GINT64_FORMAT " us to print %" G_GSIZE_FORMAT
+        " bytes, %" G_GINT64_FORMAT " us to scrape %u fields%s\n",
+        PROP_NAME_COLOR, "Text", PROP_VALUE_COLOR, text_us, text->len,
+        scrape_us, text_fields, RESET_COLOR);
+    n_print ("%s%-25s%s%" G_GINT64_FORMAT " us to print %" G_GSIZE_FORMAT
+        " bytes, %" G_GINT64_FORMAT " us to parse %u fields in %u lines, "
+        "%u malformed%s\n", PROP_NAME_COLOR, "JSON lines", PROP_VALUE_COLOR,
+        json_us, json->len, parse_us, json_fields, json_lines, bad_lines,
+        RESET_COLOR);
+    pop_indent ();
+
+    GST_INFO ("text: %" G_GINT64_FORMAT " us to scrape %" G_GSIZE_FORMAT
+        " bytes, json: %" G_GINT64_FORMAT " us to parse %" G_GSIZE_FORMAT
+        " bytes", scrape_us, text->len, parse_us, json->len);
+
+    g_string_free (text, TRUE);
+    g_string_free (json, TRUE);
 }
 
 int gst_inspect(int argc, char *argv[], CustomData *data)
@@ -2119,13 +6318,26 @@ int gst_inspect(int argc, char *argv[], CustomData *data)
     gboolean uri_handlers = FALSE;
     gboolean check_exists = FALSE;
     gboolean color_always = FALSE;
+    gboolean benchmark_print = FALSE;
+    gboolean benchmark_jobs = FALSE;
+    gboolean benchmark_json = FALSE;
+    gboolean json = FALSE;
     gchar *min_version = NULL;
+    gchar *caps_query = NULL;
+    gchar *uri_query = NULL;
+    gchar *provides = NULL;
+    gchar *path_from = NULL;
+    gchar *path_to = NULL;
+    gboolean profile = FALSE;
+    gboolean registry_diff = FALSE;
+    gchar *sections = NULL;
     guint minver_maj = GST_VERSION_MAJOR;
     guint minver_min = GST_VERSION_MINOR;
     guint minver_micro = 0;
     gchar *types = NULL;
     const gchar *no_colors;
     int exit_code = 0;
+    gint jobs = 0;
 #ifndef GST_DISABLE_OPTION_PARSING
     GOptionEntry options[] = {
             {"print-all", 'a', 0, G_OPTION_ARG_NONE, &print_all,
@@ -2137,6 +6349,10 @@ int gst_inspect(int argc, char *argv[], CustomData *data)
                 "or all plugins provide.\n                                       "
                 "Useful in connection with external automatic plugin "
                 "installation mechanisms"), NULL},
+            {"provides", '\0', 0, G_OPTION_ARG_STRING, &provides,
+             N_("Print the elements providing an automatic install detail, "
+                "e.g. \"decoder-video/x-h264\" or \"urisource-rtsp\""),
+             "DETAIL"},
             {"plugin", '\0', 0, G_OPTION_ARG_NONE, &plugin_name,
              N_("List the plugin contents"), NULL},
             {"types", 't', 0, G_OPTION_ARG_STRING, &types,
@@ -2152,6 +6368,9 @@ int gst_inspect(int argc, char *argv[], CustomData *data)
              N_
              ("Print supported URI schemes, with the elements that implement them"),
              NULL},
+            {"uri", '\0', 0, G_OPTION_ARG_STRING, &uri_query,
+             N_("Print the elements that can handle the given URI or protocol, "
+                "best ranked first"), "URI"},
             {"no-colors", '\0', G_OPTION_FLAG_REVERSE, G_OPTION_ARG_NONE,
              &colored_output,
              N_
@@ -2165,6 +6384,40 @@ int gst_inspect(int argc, char *argv[], CustomData *data)
             {"color", 'C', 0, G_OPTION_ARG_NONE, &color_always,
              N_("Color output, even when not sending to a tty."),
              NULL},
+            {"jobs", 'j', 0, G_OPTION_ARG_INT, &jobs,
+             N_("Number of threads to introspect elements on with -a, "
+                "0 for one per CPU and 1 to do it serially"), "N"},
+            {"caps", '\0', 0, G_OPTION_ARG_STRING, &caps_query,
+             N_("List the elements with pad templates that can accept or "
+                "produce the given caps"), "CAPS"},
+            {"from", '\0', 0, G_OPTION_ARG_STRING, &path_from,
+             N_("With --to, print the cheapest chains of elements converting "
+                "these caps"), "CAPS"},
+            {"to", '\0', 0, G_OPTION_ARG_STRING, &path_to,
+             N_("With --from, the caps the chains of elements should produce"),
+             "CAPS"},
+            {"sections", '\0', 0, G_OPTION_ARG_STRING, &sections,
+             N_("Comma separated parts of the element details to print: details, "
+                "hierarchy, interfaces, pad-templates, clocking, uri-handler, "
+                "pads, properties, signals, children, presets"), "SECTIONS"},
+            {"json", '\0', 0, G_OPTION_ARG_NONE, &json,
+             N_("Print element details as JSON lines, one object per section, "
+                "for tools to parse"), NULL},
+            {"diff", '\0', 0, G_OPTION_ARG_NONE, &registry_diff,
+             N_("Print the plugins and features added, removed or changed "
+                "since the last --diff, then remember the current ones"), NULL},
+            {"profile", '\0', 0, G_OPTION_ARG_NONE, &profile,
+             N_("Time creating every element and bringing it to READY, and "
+                "measure the memory it takes"), NULL},
+            {"benchmark-print", '\0', 0, G_OPTION_ARG_NONE, &benchmark_print,
+             N_("Time formatting a full -a run, and count the allocations "
+                "it takes, with the old and the current formatter"), NULL},
+            {"benchmark-jobs", '\0', 0, G_OPTION_ARG_NONE, &benchmark_jobs,
+             N_("Time a full -a run introspecting serially against one on -j "
+                "threads"), NULL},
+            {"benchmark-json", '\0', 0, G_OPTION_ARG_NONE, &benchmark_json,
+             N_("Time reading the details of all elements back from the text "
+                "output against reading them from --json output"), NULL},
             GST_TOOLS_GOPTION_VERSION,
             {NULL}
     };
@@ -2172,6 +6425,10 @@ int gst_inspect(int argc, char *argv[], CustomData *data)
     GError *err = NULL;
 #endif
 
+    /* every request is parsed afresh, don't inherit the last one's flags */
+    colored_output = TRUE;
+    sort_output = SORT_TYPE_NAME;
+
     setlocale (LC_ALL, "");
 
 #ifdef ENABLE_NLS
@@ -2202,6 +6459,19 @@ int gst_inspect(int argc, char *argv[], CustomData *data)
 
     gst_tools_print_version ();
 
+    inspect_jobs = MAX (jobs, 0);
+    inspect_json = json;
+
+    inspect_sections = INSPECT_SECTION_ALL;
+    if (sections != NULL) {
+        inspect_sections = parse_inspect_sections (sections);
+        g_free (sections);
+        if (inspect_sections == 0) {
+            inspect_sections = INSPECT_SECTION_ALL;
+            return -1;
+        }
+    }
+
     if (print_all && argc > 1) {
         g_printerr ("-a requires no extra arguments\n");
         return -1;
@@ -2230,24 +6500,27 @@ int gst_inspect(int argc, char *argv[], CustomData *data)
             g_printerr ("--exists requires an extra command line argument\n");
             exit_code = -1;
         } else {
-            if (!plugin_name) {
-                GstPluginFeature *feature;
-
-                feature = gst_registry_lookup_feature (gst_registry_get (), argv[1]);
-                if (feature != NULL && gst_plugin_feature_check_version (feature,
-                                                                         minver_maj, minver_min, minver_micro)) {
-                    exit_code = 0;
-                } else {
-                    exit_code = 1;
-                }
-
-                if (feature)
-                    gst_object_unref (feature);
-            } else {
-                /* FIXME: support checking for plugins too */
-                g_printerr ("Checking for plugins is not supported yet\n");
+            /* every argument is a "name[>=version]" spec */
+            guint8 *bits = g_new0 (guint8, (argc - 1 + 7) / 8);
+            GPtrArray *missing = g_ptr_array_new_with_free_func (g_free);
+            gint n_missing;
+            guint i;
+
+            n_missing = check_exists_batch ((const gchar * const *) argv + 1,
+                                            argc - 1, plugin_name, minver_maj, minver_min,
+                                            minver_micro, bits, missing);
+            if (n_missing < 0) {
                 exit_code = -1;
+            } else {
+                exit_code = n_missing ? 1 : 0;
+                /* a single check only answers through the exit code, as before */
+                if (argc > 2)
+                    for (i = 0; i < missing->len; i++)
+                        g_print ("missing %s\n", (gchar *) g_ptr_array_index (missing, i));
             }
+
+            g_ptr_array_unref (missing);
+            g_free (bits);
         }
         return exit_code;
     }
@@ -2256,23 +6529,66 @@ int gst_inspect(int argc, char *argv[], CustomData *data)
     /* We only support truecolor */
     colored_output &= (no_colors == NULL);
 
-#ifdef G_OS_UNIX
-    if (isatty (STDOUT_FILENO)) {
-    if (redirect_stdout ())
-      loop = g_main_loop_new (NULL, FALSE);
-  } else {
-    colored_output = (color_always) ? TRUE : FALSE;
-  }
-#elif defined(G_OS_WIN32)
-    {
-    /* g_log_writer_supports_color is available since 2.50.0 */
-    gint fd = _fileno (stdout);
-    /* On Windows 10, g_log_writer_supports_color will also setup the console
-     * so that it correctly interprets ANSI VT sequences if it's supported */
-    if (!_isatty (fd) || !g_log_writer_supports_color (fd))
-      colored_output = FALSE;
-  }
-#endif
+    /* Output ends up in the app's list view, never on a terminal or in a
+     * pager, so colors are only used when asked for */
+    colored_output = color_always && colored_output;
+
+    if (benchmark_print) {
+        benchmark_print_formatter ();
+        goto done;
+    }
+
+    if (benchmark_jobs) {
+        benchmark_parallel ();
+        goto done;
+    }
+
+    if (benchmark_json) {
+        benchmark_json_parse ();
+        goto done;
+    }
+
+    if (registry_diff) {
+        exit_code = print_registry_diff ();
+        goto done;
+    }
+
+    if (profile) {
+        print_factory_profile ();
+        goto done;
+    }
+
+    if (path_from != NULL || path_to != NULL) {
+        if (path_from == NULL || path_to == NULL) {
+            g_printerr ("--from and --to go together\n");
+            exit_code = -1;
+        } else {
+            exit_code = print_caps_paths (path_from, path_to);
+        }
+        g_free (path_from);
+        g_free (path_to);
+        g_free (caps_query);
+        goto done;
+    }
+
+    if (caps_query != NULL) {
+        exit_code = print_caps_query (caps_query);
+        g_free (caps_query);
+        goto done;
+    }
+
+    if (provides != NULL) {
+        exit_code = print_aii_providers (provides);
+        g_free (provides);
+        g_free (uri_query);
+        goto done;
+    }
+
+    if (uri_query != NULL) {
+        exit_code = print_uri_handlers_for (uri_query);
+        g_free (uri_query);
+        goto done;
+    }
 
     /* if no arguments, print out list of elements */
     if (uri_handlers) {
@@ -2336,22 +6652,95 @@ int gst_inspect(int argc, char *argv[], CustomData *data)
     }
 
     done:
+    return exit_code;
 
-#ifdef G_OS_UNIX
-    if (loop) {
-    fflush (stdout);
-    fflush (stderr);
-    /* So that the pipe we create in redirect_stdout() is closed */
-    close (STDOUT_FILENO);
-    close (STDERR_FILENO);
-    g_child_watch_add (child_pid, child_exit_cb, NULL);
-    g_main_loop_run (loop);
-    g_main_loop_unref (loop);
-  }
-#endif
+}
 
-    return exit_code;
+static void
+inspect_request_free (InspectRequest * request)
+{
+    g_free (request->module_name);
+    g_free (request);
+}
+
+/* Runs one queued request on the app_function thread */
+static gboolean
+inspect_request_run (InspectRequest * request)
+{
+    CustomData *data = request->data;
+    gchar *module_name = request->module_name;
+    InspectOutput out = { NULL, OUTPUT_CHUNK_SIZE, output_lines_store, data };
+    int exit_code;
+
+    if (request->id != g_atomic_int_get (&latest_request_id)) {
+        GST_DEBUG ("Skipping superseded request %d", request->id);
+        notify_inspect_completed (request->id, TRUE, 0, data);
+        return G_SOURCE_REMOVE;
+    }
+
+    GST_INFO ("Running request %d (%s)", request->id, module_name);
+    running_request_id = request->id;
+
+    /* Output is passed on to the UI as it is produced, start from a blank view */
+    output_lines_reset (request->id, data);
+    if (data->output_str == NULL)
+        data->output_str = g_string_sized_new (2 * OUTPUT_CHUNK_SIZE);
+    g_string_truncate (data->output_str, 0);
+    out.str = data->output_str;
+    output = &out;
+
+    //
+    // reference: https://stackoverflow.com/questions/20878322/initialize-set-char-argv-inside-main-in-one-line
+    //
+    if (strlen(module_name) > 0) {
+        gchar **args = NULL;
+        gint n_args = 0;
+        int argc;
+        char **argv;
+
+        /* split like a shell would, so options can take values, e.g.
+         * --caps "video/x-raw, format=NV12"; a half-typed quote is kept
+         * as a single argument */
+        if (!g_shell_parse_argv (module_name, &n_args, &args, NULL)) {
+            n_args = 1;
+            args = g_new0 (gchar *, 2);
+            args[0] = g_strdup (module_name);
+        }
+        argc = n_args + 1;
+        argv = g_new0 (char *, argc + 1);
+        argv[0] = "./gst-inspect";
+        memcpy (argv + 1, args, n_args * sizeof (char *));
 
+        n_print("\n\n\n[ %s ]\n\n", module_name);
+        exit_code = gst_inspect(argc, argv, data);
+
+        /* option parsing shuffles argv, free through our own copy */
+        g_free (argv);
+        g_strfreev (args);
+    } else {
+        int argc = 1;
+        char *_argv[] = {"./gst-inspect",};
+        char **argv = _argv;
+        exit_code = gst_inspect(argc, argv, data);
+    }
+
+    output = NULL;
+
+    if (inspect_cancelled ()) {
+        GST_DEBUG ("Request %d was superseded while running", request->id);
+        notify_inspect_completed (request->id, TRUE, exit_code, data);
+    } else {
+        // display the rest of the result on screen
+        inspect_output_flush (&out, TRUE);
+        output_lines_finish (data);
+
+        notify_inspect_completed (request->id, FALSE, exit_code, data);
+    }
+
+    /* Only once the result is out, writing the index takes a while. What a
+     * cancelled walk got through is worth keeping as well. */
+    inspect_index_save ();
+    return G_SOURCE_REMOVE;
 }
 
 /* Main method for the native code. This is executed on its own thread. */
@@ -2359,17 +6748,22 @@ static void *
 app_function (void *userdata)
 {
     GST_INFO("app_function()");
-    JavaVMAttachArgs args;
-    // initialize
-//    message_str = g_string_new("");
-
     CustomData *data = (CustomData *) userdata;
 
-    // display result on screen
-//    gchar *message = g_string_free(message_str, FALSE);
-//    set_ui_message(message, data);
-//    g_free(message);
-  return NULL;
+    /* Requests from nativeInspect() are dispatched on this context */
+    g_main_context_push_thread_default (data->context);
+
+    /* Have the search index ready before the user starts typing */
+    g_mutex_lock (&search_lock);
+    search_index_update ();
+    g_mutex_unlock (&search_lock);
+
+    GST_DEBUG ("Entering main loop... (CustomData:%p)", data);
+    g_main_loop_run (data->main_loop);
+    GST_DEBUG ("Exited main loop");
+
+    g_main_context_pop_thread_default (data->context);
+    return NULL;
 }
 
 /*
@@ -2389,9 +6783,26 @@ gst_native_init (JNIEnv * env, jobject thiz)
   GST_DEBUG ("Created CustomData at %p", data);
   data->app = (*env)->NewGlobalRef (env, thiz);
   GST_DEBUG ("Created GlobalRef for app object at %p", data->app);
+  /* Created here rather than on the thread so that requests can be queued
+   * before app_function() gets scheduled */
+  data->context = g_main_context_new ();
+  data->main_loop = g_main_loop_new (data->context, FALSE);
+  data->lines.text = g_string_new (NULL);
+  data->lines.ends = g_array_new (FALSE, FALSE, sizeof (guint32));
+  g_mutex_init (&data->lines.lock);
   pthread_create (&gst_app_thread, NULL, &app_function, data);
 }
 
+/* Dispatched on the app thread, so it only runs once the loop does. A quit
+ * asked for while app_function() is still building the search index would
+ * otherwise be lost when g_main_loop_run() starts. */
+static gboolean
+quit_main_loop (gpointer user_data)
+{
+  g_main_loop_quit ((GMainLoop *) user_data);
+  return G_SOURCE_REMOVE;
+}
+
 /* Quit the main loop, remove the native thread and free resources */
 static void
 gst_native_finalize (JNIEnv * env, jobject thiz)
@@ -2399,10 +6810,22 @@ gst_native_finalize (JNIEnv * env, jobject thiz)
   CustomData *data = GET_CUSTOM_DATA (env, thiz, custom_data_field_id);
   if (!data)
     return;
+  /* Abort whatever walk is running so the thread can be joined quickly */
+  g_atomic_int_inc (&latest_request_id);
   GST_DEBUG ("Quitting main loop...");
-  g_main_loop_quit (data->main_loop);
+  /* ahead of any queued requests, they are cancelled anyway */
+  g_main_context_invoke_full (data->context, G_PRIORITY_HIGH, quit_main_loop,
+      g_main_loop_ref (data->main_loop), (GDestroyNotify) g_main_loop_unref);
   GST_DEBUG ("Waiting for thread to finish...");
   pthread_join (gst_app_thread, NULL);
+  g_main_loop_unref (data->main_loop);
+  /* Drops the requests that never got to run */
+  g_main_context_unref (data->context);
+  g_mutex_clear (&data->lines.lock);
+  g_string_free (data->lines.text, TRUE);
+  g_array_unref (data->lines.ends);
+  if (data->output_str)
+    g_string_free (data->output_str, TRUE);
   GST_DEBUG ("Deleting GlobalRef for app object at %p", data->app);
   (*env)->DeleteGlobalRef (env, data->app);
   GST_DEBUG ("Freeing CustomData at %p", data);
@@ -2433,19 +6856,63 @@ gst_native_pause (JNIEnv * env, jobject thiz)
   gst_element_set_state (data->pipeline, GST_STATE_PAUSED);
 }
 
+/* Lines @start to @start + @count of the current request's output, fewer
+ * if it doesn't have that many (yet) */
+static jobjectArray
+gst_native_get_lines (JNIEnv * env, jobject thiz, jint start, jint count)
+{
+  CustomData *data = GET_CUSTOM_DATA (env, thiz, custom_data_field_id);
+  OutputLines *lines;
+  jclass string_class;
+  jobjectArray result;
+  guint first, n, i;
+
+  if (!data || start < 0 || count < 0)
+    return NULL;
+  lines = &data->lines;
+
+  string_class = (*env)->FindClass (env, "java/lang/String");
+  g_mutex_lock (&lines->lock);
+  first = MIN ((guint) start, lines->ends->len);
+  n = MIN ((guint) count, lines->ends->len - first);
+  result = (*env)->NewObjectArray (env, n, string_class, NULL);
+  for (i = 0; i < n; i++) {
+    guint line = first + i;
+    guint32 begin = line ?
+        g_array_index (lines->ends, guint32, line - 1) + 1 : 0;
+    guint32 end = g_array_index (lines->ends, guint32, line);
+    gchar saved = lines->text->str[end];
+    jstring jline;
+
+    /* terminate the line in place, nothing writes while the lock is held */
+    lines->text->str[end] = '\0';
+    jline = (*env)->NewStringUTF (env, lines->text->str + begin);
+    lines->text->str[end] = saved;
+    (*env)->SetObjectArrayElement (env, result, i, jline);
+    (*env)->DeleteLocalRef (env, jline);
+  }
+  g_mutex_unlock (&lines->lock);
+  (*env)->DeleteLocalRef (env, string_class);
+
+  return result;
+}
+
 /* Static class initializer: retrieve method and field IDs */
 static jboolean
 gst_native_class_init (JNIEnv * env, jclass klass)
 {
   custom_data_field_id =
       (*env)->GetFieldID (env, klass, "native_custom_data", "J");
-  set_message_method_id =
-      (*env)->GetMethodID (env, klass, "setMessage", "(Ljava/lang/String;)V");
+  on_lines_available_method_id =
+      (*env)->GetMethodID (env, klass, "onLinesAvailable", "(II)V");
   on_gstreamer_initialized_method_id =
       (*env)->GetMethodID (env, klass, "onGStreamerInitialized", "()V");
+  on_inspect_completed_method_id =
+      (*env)->GetMethodID (env, klass, "onInspectCompleted", "(IZI)V");
 
-  if (!custom_data_field_id || !set_message_method_id
-      || !on_gstreamer_initialized_method_id) {
+  if (!custom_data_field_id || !on_lines_available_method_id
+      || !on_gstreamer_initialized_method_id
+      || !on_inspect_completed_method_id) {
     /* We emit this message through the Android log instead of the GStreamer log because the later
      * has not been initialized yet.
      */
@@ -2462,39 +6929,135 @@ gst_native_class_init (JNIEnv * env, jclass klass)
 //  - https://developer.android.com/training/articles/perf-jni
 //  - https://stackoverflow.com/questions/18973866/getstringutfchars-function-parameter
 //
-static void
+static jint
 gst_native_inspect (JNIEnv * env, jobject thiz, jstring in_module_name)
 {
     CustomData *data = GET_CUSTOM_DATA (env, thiz, custom_data_field_id);
+    InspectRequest *request;
+    const char *module_name;
+    gint request_id;
 
-    const char *module_name = (*env)->GetStringUTFChars(env, in_module_name, NULL);
     if (!data)
-        return;
-    //GST_INFO ("gst_native_inspect()");
+        return 0;
+
+    module_name = (*env)->GetStringUTFChars(env, in_module_name, NULL);
     GST_INFO ("gst_native_inspect(%s)", module_name);
 
-    message_str = g_string_new("");
+    /* Queue the walk on app_function's context; bumping the id supersedes
+     * (and thereby cancels) anything queued or running before it */
+    request = g_new0 (InspectRequest, 1);
+    request->id = request_id = g_atomic_int_add (&latest_request_id, 1) + 1;
+    request->module_name = g_strdup (module_name);
+    request->data = data;
+    (*env)->ReleaseStringUTFChars(env, in_module_name, module_name);
 
-    //
-    // reference: https://stackoverflow.com/questions/20878322/initialize-set-char-argv-inside-main-in-one-line
-    //
-    if (strlen(module_name) > 0) {
-        int argc = 2;
-        char *_argv[] = {"./gst-inspect", module_name,};
-        char **argv = _argv;
-        n_print("\n\n\n[ %s ]\n\n", module_name);
-        gst_inspect(argc, argv, data);
-    } else {
-        int argc = 1;
-        char *_argv[] = {"./gst-inspect",};
-        char **argv = _argv;
-        gst_inspect(argc, argv, data);
+    g_main_context_invoke_full (data->context, G_PRIORITY_DEFAULT,
+        (GSourceFunc) inspect_request_run, request,
+        (GDestroyNotify) inspect_request_free);
+
+    return request_id;
+}
+
+/* As-you-type lookup of feature names, see search_index_query() */
+static jobjectArray
+gst_native_search (JNIEnv * env, jobject thiz, jstring in_query, jint limit)
+{
+  const char *query = (*env)->GetStringUTFChars (env, in_query, NULL);
+  GPtrArray *matches = search_index_query (query, MAX (limit, 0));
+  jclass string_class;
+  jobjectArray result;
+  guint i;
+
+  (*env)->ReleaseStringUTFChars (env, in_query, query);
+
+  string_class = (*env)->FindClass (env, "java/lang/String");
+  result = (*env)->NewObjectArray (env, matches->len, string_class, NULL);
+  for (i = 0; i < matches->len; i++) {
+    jstring name = (*env)->NewStringUTF (env, g_ptr_array_index (matches, i));
+    (*env)->SetObjectArrayElement (env, result, i, name);
+    (*env)->DeleteLocalRef (env, name);
+  }
+  (*env)->DeleteLocalRef (env, string_class);
+  g_ptr_array_unref (matches);
+
+  return result;
+}
+
+/* Name of the best element to read (or with @sink, write) @in_uri, or
+ * NULL, see uri_index_lookup() */
+static jstring
+gst_native_find_uri_handler (JNIEnv * env, jobject thiz, jstring in_uri,
+    jboolean sink)
+{
+  const char *uri = (*env)->GetStringUTFChars (env, in_uri, NULL);
+  gchar *protocol = gst_uri_get_protocol (uri);
+  GstElementFactory *factory = NULL;
+  jstring name = NULL;
+
+  (*env)->ReleaseStringUTFChars (env, in_uri, uri);
+  if (protocol == NULL)
+    return NULL;
+
+  factory = uri_index_lookup (protocol, sink ? GST_URI_SINK : GST_URI_SRC);
+  if (factory) {
+    name = (*env)->NewStringUTF (env, GST_OBJECT_NAME (factory));
+    gst_object_unref (factory);
+  }
+  g_free (protocol);
+
+  return name;
+}
+
+/* Check all "name[>=version]" @in_specs at once. Returns a bitset with
+ * bit i set when spec i is satisfied, see check_exists_batch(). The specs
+ * that are not met go to the start of @out_missing, if given, in order;
+ * the slots after them are set to null. */
+static jbyteArray
+gst_native_check_exists (JNIEnv * env, jobject thiz, jobjectArray in_specs,
+    jboolean plugins, jobjectArray out_missing)
+{
+  jsize n_specs = (*env)->GetArrayLength (env, in_specs);
+  gchar **specs = g_new0 (gchar *, n_specs + 1);
+  gsize n_bytes = (n_specs + 7) / 8;
+  guint8 *bits = g_new0 (guint8, MAX (n_bytes, 1));
+  GPtrArray *missing = g_ptr_array_new_with_free_func (g_free);
+  jbyteArray result = NULL;
+  gint n_missing;
+  jsize i;
+
+  for (i = 0; i < n_specs; i++) {
+    jstring in_spec = (*env)->GetObjectArrayElement (env, in_specs, i);
+    const char *spec = (*env)->GetStringUTFChars (env, in_spec, NULL);
+
+    specs[i] = g_strdup (spec);
+    (*env)->ReleaseStringUTFChars (env, in_spec, spec);
+    (*env)->DeleteLocalRef (env, in_spec);
+  }
+
+  n_missing = check_exists_batch ((const gchar * const *) specs, n_specs,
+      plugins, GST_VERSION_MAJOR, GST_VERSION_MINOR, 0, bits, missing);
+  if (n_missing >= 0) {
+    jsize n_out = out_missing ? (*env)->GetArrayLength (env, out_missing) : 0;
+
+    for (i = 0; i < missing->len; i++)
+      GST_INFO ("Missing %s", (gchar *) g_ptr_array_index (missing, i));
+    for (i = 0; i < n_out; i++) {
+      jstring spec = NULL;
+
+      if (i < missing->len)
+        spec = (*env)->NewStringUTF (env, g_ptr_array_index (missing, i));
+      (*env)->SetObjectArrayElement (env, out_missing, i, spec);
+      if (spec)
+        (*env)->DeleteLocalRef (env, spec);
     }
+    result = (*env)->NewByteArray (env, n_bytes);
+    (*env)->SetByteArrayRegion (env, result, 0, n_bytes, (jbyte *) bits);
+  }
 
-    // display result on screen
-    gchar *message = g_string_free(message_str, FALSE);
-    set_ui_message(message, data);
-    g_free(message);
+  g_ptr_array_unref (missing);
+  g_free (bits);
+  g_strfreev (specs);
+  return result;
 }
 
 /* List of implemented native methods */
@@ -2505,7 +7068,14 @@ static JNINativeMethod native_methods[] = {
   {"nativePause", "()V", (void *) gst_native_pause},
   {"nativeClassInit", "()Z", (void *) gst_native_class_init},
   // reference: https://intrepidgeeks.com/tutorial/jni-field-descriptor-ljavalangstring-v-syntax-definition
-  {"nativeInspect", "(Ljava/lang/String;)V", (void *) gst_native_inspect},
+  {"nativeInspect", "(Ljava/lang/String;)I", (void *) gst_native_inspect},
+  {"nativeGetLines", "(II)[Ljava/lang/String;", (void *) gst_native_get_lines},
+  {"nativeSearch", "(Ljava/lang/String;I)[Ljava/lang/String;",
+      (void *) gst_native_search},
+  {"nativeFindUriHandler", "(Ljava/lang/String;Z)Ljava/lang/String;",
+      (void *) gst_native_find_uri_handler},
+  {"nativeCheckExists", "([Ljava/lang/String;Z[Ljava/lang/String;)[B",
+      (void *) gst_native_check_exists},
 };
 
 /* Library initializer */
@@ -2,15 +2,27 @@ package org.freedesktop.gstreamer.tools.inspect;
 
 import android.app.Activity;
 import android.os.Bundle;
+import android.text.Editable;
+import android.text.TextWatcher;
 import android.util.Log;
+import android.view.LayoutInflater;
 import android.view.View;
 import android.view.View.OnClickListener;
+import android.view.ViewGroup;
+import android.widget.ArrayAdapter;
+import android.widget.AutoCompleteTextView;
+import android.widget.BaseAdapter;
 import android.widget.Button;
-import android.widget.EditText;
+import android.widget.Filter;
 import android.widget.ImageButton;
+import android.widget.ListView;
 import android.widget.TextView;
 import android.widget.Toast;
 
+import java.util.ArrayList;
+import java.util.Arrays;
+import java.util.List;
+
 import org.freedesktop.gstreamer.GStreamer;
 import org.freedesktop.gstreamer.R;
 
@@ -21,10 +33,131 @@ public class Inspect extends Activity {
     private native void nativePlay();     // Set pipeline to PLAYING
     private native void nativePause();    // Set pipeline to PAUSED
     private static native boolean nativeClassInit(); // Initialize native class: cache Method IDs for callbacks
-    private native void nativeInspect(String module_name);
+    private native int nativeInspect(String module_name); // Queue an inspect request, returns its id
+    private native String[] nativeGetLines(int start, int count); // Lines of the current output, see OutputAdapter
+    private native String[] nativeSearch(String query, int limit); // Best matching feature names, best first
+    private native String nativeFindUriHandler(String uri, boolean sink); // Best element for a URI, or null
+    // Bit i set if "name[>=version]" spec i is met. The unmet specs are stored at the start of missing
+    // (null for none, specs.length to hold them all) and the rest of it is cleared.
+    private native byte[] nativeCheckExists(String[] specs, boolean plugins, String[] missing);
     private long native_custom_data;      // Native code will use this to keep private data
 
     private boolean is_playing_desired;   // Whether the user asked to go to PLAYING
+    private int last_request_id;          // Id of the most recent inspect request
+    private boolean is_destroyed;         // Output is gone once native code is finalized
+    private OutputAdapter output_adapter; // Shows the output of the current request
+
+    private static final int MAX_SUGGESTIONS = 20;
+    private static final int LINES_PER_PAGE = 200;
+
+    // The output stays in native memory. The list only knows how many lines there are and fetches
+    // the page around what is on screen, so a full dump never gets laid out at once.
+    private class OutputAdapter extends BaseAdapter {
+        private int request_id;
+        private int line_count;
+        private int page_start;
+        private String[] page = new String[0];
+
+        void setLineCount(int id, int count) {
+            // Late news about an earlier request, its lines are gone natively
+            if (id < request_id)
+                return;
+            if (id != request_id) {
+                // Whatever was fetched belongs to the previous output
+                request_id = id;
+                page = new String[0];
+                page_start = 0;
+            } else if (page.length < LINES_PER_PAGE) {
+                // A short page may have been fetched before these lines existed
+                page = new String[0];
+            }
+            line_count = count;
+            notifyDataSetChanged();
+        }
+
+        @Override
+        public int getCount() {
+            return line_count;
+        }
+
+        @Override
+        public String getItem(int position) {
+            if (position < page_start || position >= page_start + page.length) {
+                if (is_destroyed)
+                    return "";
+                page_start = Math.max(0, position - LINES_PER_PAGE / 2);
+                page = nativeGetLines(page_start, LINES_PER_PAGE);
+                if (page == null)
+                    page = new String[0];
+                if (position >= page_start + page.length)
+                    return "";
+            }
+            return page[position - page_start];
+        }
+
+        @Override
+        public long getItemId(int position) {
+            return position;
+        }
+
+        @Override
+        public View getView(int position, View convertView, ViewGroup parent) {
+            TextView line = (TextView) convertView;
+            if (line == null)
+                line = (TextView) LayoutInflater.from(Inspect.this).inflate(R.layout.output_line, parent, false);
+            line.setText(getItem(position));
+            return line;
+        }
+    }
+
+    // Suggests feature names from the native search index. Filtering runs on the adapter's worker
+    // thread, so lookups never block typing.
+    private class SearchAdapter extends ArrayAdapter<String> {
+        private List<String> suggestions = new ArrayList<String>();
+
+        SearchAdapter() {
+            super(Inspect.this, android.R.layout.simple_dropdown_item_1line);
+        }
+
+        @Override
+        public int getCount() {
+            return suggestions.size();
+        }
+
+        @Override
+        public String getItem(int position) {
+            return suggestions.get(position);
+        }
+
+        @Override
+        public Filter getFilter() {
+            return new Filter() {
+                @Override
+                protected FilterResults performFiltering(CharSequence constraint) {
+                    FilterResults results = new FilterResults();
+                    if (constraint == null || is_destroyed)
+                        return results;
+                    List<String> names = Arrays.asList(nativeSearch(constraint.toString(), MAX_SUGGESTIONS));
+                    results.values = names;
+                    results.count = names.size();
+                    return results;
+                }
+
+                @Override
+                @SuppressWarnings("unchecked")
+                protected void publishResults(CharSequence constraint, FilterResults results) {
+                    if (results.values != null)
+                        suggestions = (List<String>) results.values;
+                    else
+                        suggestions = new ArrayList<String>();
+                    if (results.count > 0)
+                        notifyDataSetChanged();
+                    else
+                        notifyDataSetInvalidated();
+                }
+            };
+        }
+    }
 
     // Called when the activity is first created.
     @Override
@@ -71,14 +204,33 @@ public class Inspect extends Activity {
         this.findViewById(R.id.button_play).setEnabled(false);
         this.findViewById(R.id.button_stop).setEnabled(false);
 
+        output_adapter = new OutputAdapter();
+        ListView output_view = (ListView) this.findViewById(R.id.listview_output);
+        output_view.setAdapter(output_adapter);
+
         Button inspect = (Button) this.findViewById(R.id.button_inspect);
-        final Activity activity = this;
+        final AutoCompleteTextView inputView = (AutoCompleteTextView) this.findViewById(R.id.editTextTextModuleName);
+        inputView.setAdapter(new SearchAdapter());
         inspect.setOnClickListener(new OnClickListener() {
             @Override
             public void onClick(View view) {
-                final EditText inputView = (EditText) activity.findViewById(R.id.editTextTextModuleName);
                 String module_name = inputView.getText().toString();
-                nativeInspect(module_name);
+                last_request_id = nativeInspect(module_name);
+            }
+        });
+
+        // Every keystroke queues a new request, which cancels the one still running natively
+        inputView.addTextChangedListener(new TextWatcher() {
+            public void beforeTextChanged(CharSequence s, int start, int count, int after) {
+            }
+
+            public void onTextChanged(CharSequence s, int start, int before, int count) {
+            }
+
+            public void afterTextChanged(Editable s) {
+                String module_name = s.toString().trim();
+                if (module_name.length() > 0)
+                    last_request_id = nativeInspect(module_name);
             }
         });
 
@@ -91,20 +243,28 @@ public class Inspect extends Activity {
     }
 
     protected void onDestroy() {
+        is_destroyed = true;
         nativeFinalize();
         super.onDestroy();
     }
 
-    // Called from native code. This sets the content of the TextView from the UI thread.
-    private void setMessage(final String message) {
-        final TextView tv = (TextView) this.findViewById(R.id.textview_message);
+    // Called from native code whenever the current request has printed more lines.
+    private void onLinesAvailable(final int request_id, final int line_count) {
         runOnUiThread (new Runnable() {
           public void run() {
-            tv.setText(message);
+            if (is_destroyed)
+              return;
+            output_adapter.setLineCount(request_id, line_count);
           }
         });
     }
 
+    // Called from native code once an inspect request has finished or was superseded by a newer one.
+    private void onInspectCompleted(final int request_id, final boolean cancelled, final int exit_code) {
+        Log.d ("GStreamer", "Inspect request " + request_id + (cancelled ? " cancelled" : " done, exit code " + exit_code)
+                + (request_id == last_request_id ? "" : " (stale)"));
+    }
+
     // Called from native code. Native code calls this once it has created its pipeline and
     // the main loop is running, so it is ready to accept commands.
     private void onGStreamerInitialized () {